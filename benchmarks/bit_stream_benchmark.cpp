@@ -0,0 +1,40 @@
+#include <bitpack/bit_stream.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Measures single threaded bit_writer and bit_reader throughput on a mix of field widths.
+// Usage: bitpack_bit_stream_benchmark [fields]
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t(1) << 26;
+
+    std::vector<std::uint8_t> bytes;
+    const auto encode = [&]() {
+        bytes.clear();
+        bitpack::bit_writer writer(bitpack::vector_sink { bytes });
+        for(size_t i = 0; i < n; ++i) { writer.write(i, 7 + (i & 31)); }
+    };
+
+    // The first run only grows and touches the output so the timed run measures the writer
+    encode();
+    const auto write_start = std::chrono::steady_clock::now();
+    encode();
+    const auto write_end = std::chrono::steady_clock::now();
+
+    std::uint64_t checksum = 0;
+    bitpack::bit_reader reader(bitpack::buffer_source { bytes.data(), bytes.size() });
+    for(size_t i = 0; i < n; ++i) { checksum += reader.read(7 + (i & 31)); }
+    const auto read_end = std::chrono::steady_clock::now();
+
+    const double gb      = static_cast<double>(bytes.size()) / 1e9;
+    const double write_s = std::chrono::duration<double>(write_end - write_start).count();
+    const double read_s  = std::chrono::duration<double>(read_end - write_end).count();
+    std::cout << "fields: " << n << ", bytes: " << bytes.size() << "\n";
+    std::cout << "encode: " << gb / write_s << " GB/s\n";
+    std::cout << "decode: " << gb / read_s << " GB/s\n";
+
+    return checksum == 0 ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/columnar_file.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Measures how many column bytes zone maps let a range scan skip, on a clustered and an unclustered field.
+// Usage: bitpack_columnar_scan_benchmark [rows]
+int main(int argc, char** argv) {
+    using record_layout = bitpack::fast_layout<bitpack::bitwidth<32>, bitpack::bitwidth<12>, bitpack::bitwidth<20>>;
+    using record        = bitpack::bitpack<record_layout>;
+
+    const size_t n         = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t(1) << 24;
+    const std::string path = std::string(P_tmpdir) + "/bitpack_columnar_scan_benchmark.bin";
+
+    // Field 0 is a timestamp in arrival order, field 1 a pseudo random category
+    std::vector<record> records(n);
+    std::uint64_t state = 0x9E3779B97F4A7C15ull;
+    for(size_t i = 0; i < n; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        records[i].set<0>(i * 4 + (state & 3));
+        records[i].set<1>(state >> 52);
+        records[i].set<2>(i & 0xFFFFF);
+    }
+    if(bitpack::write_columnar_file(path.c_str(), records) != bitpack::packed_file_status::OK) {
+        std::cerr << "failed to write " << path << "\n";
+        return 1;
+    }
+
+    const auto report = [&](const char* name, auto&& scan) {
+        std::uint64_t matches = 0;
+        const auto start      = std::chrono::steady_clock::now();
+        const bitpack::scan_stats stats = scan([&](size_t, std::uint64_t) { ++matches; });
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << matches << " matches, " << stats.blocks_scanned << " blocks scanned, "
+                  << stats.blocks_skipped << " skipped, " << stats.bytes_scanned << " bytes read, " << stats.bytes_skipped
+                  << " bytes skipped, " << seconds * 1e3 << " ms\n";
+    };
+
+    for(const auto access : { bitpack::columnar_access::MMAP, bitpack::columnar_access::PREAD }) {
+        bitpack::columnar_file<record_layout> file;
+        if(file.open(path.c_str(), access) != bitpack::packed_file_status::OK) {
+            std::cerr << "failed to open " << path << "\n";
+            return 1;
+        }
+        std::cout << (access == bitpack::columnar_access::MMAP ? "mmap" : "pread") << "\n";
+        // One percent of the timestamp range, in the middle of the file
+        const std::uint64_t lo = n * 4 / 2;
+        const std::uint64_t hi = lo + n * 4 / 100;
+        report("  clustered field", [&](auto&& fn) { return file.scan<0>(lo, hi, fn); });
+        report("  unclustered field", [&](auto&& fn) { return file.scan<1>(40, 80, fn); });
+    }
+    std::remove(path.c_str());
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/convert.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Compares migrating records to a new schema version with get<I>/set<J> per field against bitpack::convert.
+// Usage: bitpack_convert_benchmark [rows]
+enum class fields {
+    ID,
+    TIME,
+    KIND,
+    FLAGS,
+    SCORE
+};
+
+template<size_t W, fields F>
+using field = bitpack::bitwidth<W, bitpack::field_tag<F>>;
+
+// Version 2 widens KIND and adds SCORE at the end
+using v1_layout =
+    bitpack::fast_layout<field<24, fields::ID>, field<20, fields::TIME>, field<6, fields::KIND>, field<8, fields::FLAGS>>;
+using v2_layout = bitpack::fast_layout<field<24, fields::ID>,
+                                       field<20, fields::TIME>,
+                                       field<8, fields::KIND>,
+                                       field<8, fields::FLAGS>,
+                                       field<4, fields::SCORE>>;
+using v1 = bitpack::bitpack<v1_layout>;
+using v2 = bitpack::bitpack<v2_layout>;
+
+template<typename F>
+void run(const char* name, const std::vector<v1>& in, std::vector<v2>& out, F&& migrate) {
+    const auto start = std::chrono::steady_clock::now();
+    for(int repeat = 0; repeat < 10; ++repeat) { migrate(in, out); }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::uint64_t sum    = 0;
+    for(const v2& record : out) { sum += record.get<fields::KIND>(); }
+    std::cout << name << ": " << seconds * 100 << " ms per migration (checksum " << sum << ")\n";
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t(1) << 24;
+    std::vector<v1> records(n);
+    for(size_t i = 0; i < n; ++i) {
+        records[i].set<fields::ID>(i % (1 << 24));
+        records[i].set<fields::TIME>(i * 7 % (1 << 20));
+        records[i].set<fields::KIND>(i % 64);
+        records[i].set<fields::FLAGS>(i % 251);
+    }
+    std::vector<v2> migrated(n);
+
+    run("field by field", records, migrated, [](const std::vector<v1>& in, std::vector<v2>& out) {
+        for(size_t i = 0; i < in.size(); ++i) {
+            v2 record;
+            record.set<fields::ID>(in[i].get<fields::ID>());
+            record.set<fields::TIME>(in[i].get<fields::TIME>());
+            record.set<fields::KIND>(in[i].get<fields::KIND>());
+            record.set<fields::FLAGS>(in[i].get<fields::FLAGS>());
+            out[i] = record;
+        }
+    });
+    run("convert", records, migrated, [](const std::vector<v1>& in, std::vector<v2>& out) {
+        bitpack::convert(in.data(), in.size(), out.data());
+    });
+    return 0;
+}
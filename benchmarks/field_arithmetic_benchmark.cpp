@@ -0,0 +1,49 @@
+#include <bitpack/bitpack.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Compares bumping the counters of per-key statistics records with get/set against the in place add, increment and
+// saturating_add. Each event increments a key's hit count and adds to its total and to a small saturating error score.
+// Usage: bitpack_field_arithmetic_benchmark [events]
+using stats_layout = bitpack::fast_layout<bitpack::bitwidth<20>, bitpack::bitwidth<36>, bitpack::bitwidth<8>>;
+using stats        = bitpack::bitpack<stats_layout>;
+
+constexpr size_t keys = size_t(1) << 14;
+
+template<typename F>
+void run(const char* name, const std::vector<std::uint32_t>& events, F&& bump) {
+    std::vector<stats> table(keys);
+    const auto start = std::chrono::steady_clock::now();
+    for(const std::uint32_t event : events) { bump(table[event % keys], event >> 24); }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::uint64_t sum    = 0;
+    for(const stats& s : table) { sum += s.get<0>() + s.get<1>() + s.get<2>(); }
+    std::cout << name << ": " << seconds * 1e9 / events.size() << " ns per event (checksum " << sum << ")\n";
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t(1) << 26;
+    std::vector<std::uint32_t> events(n);
+    std::uint32_t state = 12345;
+    for(std::uint32_t& event : events) {
+        state = state * 1664525u + 1013904223u;
+        event = state;
+    }
+
+    run("get/set", events, [](stats& s, std::uint32_t value) {
+        s.set<0>((s.get<0>() + 1) & bitpack::bitmask_v<std::uint64_t, 20>);
+        s.set<1>((s.get<1>() + value) & bitpack::bitmask_v<std::uint64_t, 36>);
+        const std::uint64_t score = s.get<2>() + (value & 3);
+        s.set<2>(score > 255 ? 255 : score);
+    });
+    run("add/saturating_add", events, [](stats& s, std::uint32_t value) {
+        s.increment<0>();
+        s.add<1>(value);
+        s.saturating_add<2>(value & 3);
+    });
+    return 0;
+}
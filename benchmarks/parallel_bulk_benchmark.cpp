@@ -0,0 +1,48 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/bulk.hpp>
+#include <bitpack/thread_pool.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Measures how parallel_pack_columns and parallel_unpack_column scale with the number of threads.
+// Usage: bitpack_parallel_bulk_benchmark [rows] [max threads]
+int main(int argc, char** argv) {
+    using row_layout = bitpack::fast_layout<bitpack::bitwidth<12>, bitpack::bitwidth<20>, bitpack::bitwidth<32>>;
+    using row        = bitpack::bitpack<row_layout>;
+
+    const size_t n           = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t(1) << 26;
+    const size_t max_threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+
+    std::vector<std::uint16_t> ids(n);
+    std::vector<std::uint32_t> regions(n);
+    std::vector<std::uint64_t> values(n);
+    for(size_t i = 0; i < n; ++i) {
+        ids[i]     = static_cast<std::uint16_t>(i % 4096);
+        regions[i] = static_cast<std::uint32_t>(i % (1 << 20));
+        values[i]  = i & 0xFFFFFFFFu;
+    }
+    std::vector<row> rows(n);
+    std::vector<std::uint64_t> unpacked(n);
+
+    std::cout << "rows: " << n << "\n";
+    std::cout << "threads\tpack (Mrows/s)\tunpack (Mrows/s)\n";
+    for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+        bitpack::work_stealing_pool pool(threads);
+
+        const auto pack_start = std::chrono::steady_clock::now();
+        bitpack::parallel_pack_columns(pool, rows, ids, regions, values);
+        const auto pack_end = std::chrono::steady_clock::now();
+        bitpack::parallel_unpack_column<2>(pool, rows, unpacked);
+        const auto unpack_end = std::chrono::steady_clock::now();
+
+        const double pack_s   = std::chrono::duration<double>(pack_end - pack_start).count();
+        const double unpack_s = std::chrono::duration<double>(unpack_end - pack_end).count();
+        std::cout << threads << "\t" << n / pack_s / 1e6 << "\t" << n / unpack_s / 1e6 << "\n";
+    }
+
+    return unpacked[n / 2] == values[n / 2] ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/split_packed_array.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Compares scanning the hot fields of 120 bit records stored split against the same records stored whole.
+// Usage: bitpack_split_packed_array_benchmark [rows]
+using record_layout = bitpack::small_layout<bitpack::bitwidth<12>,
+                                            bitpack::bitwidth<30>,
+                                            bitpack::bitwidth<40>,
+                                            bitpack::bitwidth<27>,
+                                            bitpack::bitwidth<8>,
+                                            bitpack::bitwidth<3>>;
+using split_array   = bitpack::split_packed_array<record_layout, 0, 4>;
+using whole_array   = bitpack::split_packed_array<record_layout>;
+
+template<typename A>
+void run(const char* name, size_t n) {
+    A records(n);
+    for(size_t i = 0; i < n; ++i) {
+        records.template set<0>(i, i % 4096);
+        records.template set<4>(i, i % 200);
+        records.template set<2>(i, i);
+    }
+
+    std::uint64_t sum = 0;
+    const auto start  = std::chrono::steady_clock::now();
+    for(int repeat = 0; repeat < 10; ++repeat) {
+        for(size_t i = 0; i < n; ++i) {
+            if(records.template get<4>(i) == 42) {
+                sum += records.template get<0>(i);
+            }
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // Without hot fields every scanned field lives in the cold array
+    const size_t working_set = A::hot_layout::field_sizes.empty() ? records.cold_bytes() : records.hot_bytes();
+    std::cout << name << ": hot path working set " << working_set << " bytes, " << seconds * 100 << " ms per scan (checksum "
+              << sum << ")\n";
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t(1) << 24;
+    run<whole_array>("whole records", n);
+    run<split_array>("split records", n);
+    return 0;
+}
@@ -0,0 +1,242 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_ACCESS_PROFILE_HPP
+#define BITPACK_ACCESS_PROFILE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bitpack/detail/type_name.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+
+    Counting of bitpack::get and bitpack::set calls per field, enabled by defining BITPACK_PROFILE_ACCESS before including
+    bitpack.hpp (bitpack.hpp includes this header itself). Without the macro none of this is included and get and set are
+    unchanged.
+
+    Each thread counts into its own counters, which only it writes, so counting never contends. Reports add up the
+    counters of live threads and of threads that have exited. A report is written to stderr at exit unless turned off
+    with report_access_profile_at_exit(false).
+
+*/
+
+namespace bitpack {
+    /**
+     * @brief The number of get and set calls made on each field of one layout
+     *
+     */
+    struct field_access_counts {
+        std::string layout;
+        std::vector<std::uint64_t> gets;
+        std::vector<std::uint64_t> sets;
+
+        std::uint64_t total() const noexcept {
+            std::uint64_t sum = 0;
+            for(size_t f = 0; f < gets.size(); ++f) { sum += gets[f] + sets[f]; }
+            return sum;
+        }
+    };
+
+    namespace detail {
+        enum class access_kind {
+            GET,
+            SET
+        };
+
+        class access_registry {
+            struct thread_counters;
+
+        public:
+            static access_registry& instance() {
+                static access_registry registry;
+                return registry;
+            }
+
+            size_t add_layout(std::string name, size_t fields) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _layouts.push_back({ std::move(name), std::vector<std::uint64_t>(fields), std::vector<std::uint64_t>(fields) });
+                return _layouts.size() - 1;
+            }
+
+            void record(size_t layout, size_t field, access_kind kind) noexcept {
+                thread_local thread_counters counters(*this);
+                std::atomic<std::uint64_t>* row = counters.row(layout);
+                std::atomic<std::uint64_t>& count = row[2 * field + (kind == access_kind::SET ? 1 : 0)];
+                // Only this thread writes its counters, so a plain load and store is enough
+                count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            std::vector<field_access_counts> snapshot() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                std::vector<field_access_counts> result = _layouts;
+                for(const thread_counters* counters : _threads) { counters->add_to(result); }
+                return result;
+            }
+
+            void reset() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for(auto& layout : _layouts) {
+                    std::fill(layout.gets.begin(), layout.gets.end(), 0);
+                    std::fill(layout.sets.begin(), layout.sets.end(), 0);
+                }
+                for(thread_counters* counters : _threads) { counters->clear(); }
+            }
+
+            void report_at_exit(bool enabled) noexcept { _report_at_exit = enabled; }
+
+            ~access_registry();
+
+        private:
+            // One thread's counters: a row per layout with a get and a set count per field
+            struct thread_counters {
+                access_registry& registry;
+                std::vector<std::unique_ptr<std::atomic<std::uint64_t>[]>> rows;
+                std::vector<size_t> widths;
+
+                explicit thread_counters(access_registry& owner) : registry(owner) {
+                    std::lock_guard<std::mutex> lock(registry._mutex);
+                    registry._threads.push_back(this);
+                }
+
+                ~thread_counters() {
+                    std::lock_guard<std::mutex> lock(registry._mutex);
+                    add_to(registry._layouts);
+                    registry._threads.erase(std::find(registry._threads.begin(), registry._threads.end(), this));
+                }
+
+                std::atomic<std::uint64_t>* row(size_t layout) {
+                    if(layout >= rows.size()) {
+                        // Growing is rare and happens under the lock so reports never see a half grown table
+                        std::lock_guard<std::mutex> lock(registry._mutex);
+                        while(rows.size() <= layout) {
+                            const size_t fields = registry._layouts[rows.size()].gets.size();
+                            rows.emplace_back(new std::atomic<std::uint64_t>[2 * fields]());
+                            widths.push_back(fields);
+                        }
+                    }
+                    return rows[layout].get();
+                }
+
+                void add_to(std::vector<field_access_counts>& totals) const {
+                    for(size_t l = 0; l < rows.size(); ++l) {
+                        for(size_t f = 0; f < widths[l]; ++f) {
+                            totals[l].gets[f] += rows[l][2 * f].load(std::memory_order_relaxed);
+                            totals[l].sets[f] += rows[l][2 * f + 1].load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                void clear() {
+                    for(size_t l = 0; l < rows.size(); ++l) {
+                        for(size_t c = 0; c < 2 * widths[l]; ++c) { rows[l][c].store(0, std::memory_order_relaxed); }
+                    }
+                }
+            };
+
+            std::mutex _mutex;
+            std::vector<field_access_counts> _layouts;
+            std::vector<thread_counters*> _threads;
+            bool _report_at_exit = true;
+        };
+
+        template<typename L>
+        size_t access_profile_id() {
+            static const size_t id = access_registry::instance().add_layout(type_name<L>(), L::field_sizes.size());
+            return id;
+        }
+
+        template<typename L>
+        void record_access(size_t field, access_kind kind) noexcept {
+            access_registry::instance().record(access_profile_id<L>(), field, kind);
+        }
+    }
+
+    /**
+     * @brief Gets the get and set counts of every layout accessed so far, summed over all threads
+     *
+     */
+    inline std::vector<field_access_counts> access_profile() { return detail::access_registry::instance().snapshot(); }
+
+    /**
+     * @brief Sets every count back to zero
+     *
+     */
+    inline void reset_access_profile() { detail::access_registry::instance().reset(); }
+
+    /**
+     * @brief Chooses whether a report is written to stderr at exit. It is by default.
+     *
+     */
+    inline void report_access_profile_at_exit(bool enabled) { detail::access_registry::instance().report_at_exit(enabled); }
+
+    /**
+     * @brief Writes a report of the counts, with the layouts and their fields from most to least accessed
+     *
+     * @param out The stream to write to
+     * @param profile The counts to report, by default the current ones
+     */
+    inline void write_access_profile(std::ostream& out, std::vector<field_access_counts> profile = access_profile()) {
+        std::sort(profile.begin(), profile.end(), [](const auto& lhs, const auto& rhs) { return lhs.total() > rhs.total(); });
+        out << "bitpack field access profile\n";
+        for(const field_access_counts& layout : profile) {
+            const std::uint64_t total = layout.total();
+            if(total == 0) {
+                continue;
+            }
+            out << layout.layout << ": " << total << " accesses\n";
+            std::vector<size_t> order(layout.gets.size());
+            for(size_t f = 0; f < order.size(); ++f) { order[f] = f; }
+            std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+                return layout.gets[lhs] + layout.sets[lhs] > layout.gets[rhs] + layout.sets[rhs];
+            });
+            for(const size_t f : order) {
+                const std::uint64_t accesses = layout.gets[f] + layout.sets[f];
+                out << "  field " << f << ": " << layout.gets[f] << " gets, " << layout.sets[f] << " sets, "
+                    << (100.0 * static_cast<double>(accesses) / static_cast<double>(total)) << "%\n";
+            }
+        }
+    }
+
+    inline detail::access_registry::~access_registry() {
+        if(!_report_at_exit) {
+            return;
+        }
+        std::vector<field_access_counts> totals = _layouts;
+        for(const thread_counters* counters : _threads) { counters->add_to(totals); }
+        bool accessed = false;
+        for(const auto& layout : totals) { accessed = accessed || layout.total() != 0; }
+        if(accessed) {
+            write_access_profile(std::cerr, std::move(totals));
+        }
+    }
+}
+
+#endif
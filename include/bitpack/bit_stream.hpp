@@ -0,0 +1,362 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_BIT_STREAM_HPP
+#define BITPACK_BIT_STREAM_HPP
+
+#include <algorithm>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    /*
+
+        Byte sinks and sources used by bit_writer and bit_reader. A sink provides bool write(const void* data, size_t bytes)
+        and a source provides size_t read(void* data, size_t bytes), which returns the number of bytes read (0 at the end).
+        Any type with these members can be used.
+
+    */
+
+    /**
+     * @brief Sink that appends bytes to a vector
+     *
+     */
+    class vector_sink {
+    public:
+        explicit vector_sink(std::vector<std::uint8_t>& bytes) noexcept : _bytes(&bytes) { }
+
+        bool write(const void* data, size_t bytes) {
+            const auto* src = static_cast<const std::uint8_t*>(data);
+            _bytes->insert(_bytes->end(), src, src + bytes);
+            return true;
+        }
+
+    private:
+        std::vector<std::uint8_t>* _bytes;
+    };
+
+    /**
+     * @brief Sink that writes bytes to a C file stream. The stream is not closed by the sink.
+     *
+     */
+    class file_sink {
+    public:
+        explicit file_sink(std::FILE* file) noexcept : _file(file) { }
+
+        bool write(const void* data, size_t bytes) noexcept { return std::fwrite(data, 1, bytes, _file) == bytes; }
+
+    private:
+        std::FILE* _file;
+    };
+
+    /**
+     * @brief Source that reads from a block of memory, such as a buffer or a memory mapped file
+     *
+     */
+    class buffer_source {
+    public:
+        buffer_source(const void* data, size_t size) noexcept : _data(static_cast<const std::uint8_t*>(data)), _size(size) { }
+
+        size_t read(void* data, size_t bytes) noexcept {
+            bytes = std::min(bytes, _size - _position);
+            std::memcpy(data, _data + _position, bytes);
+            _position += bytes;
+            return bytes;
+        }
+
+    private:
+        const std::uint8_t* _data;
+        size_t _size;
+        size_t _position = 0;
+    };
+
+    /**
+     * @brief Source that reads bytes from a C file stream. The stream is not closed by the source.
+     *
+     */
+    class file_source {
+    public:
+        explicit file_source(std::FILE* file) noexcept : _file(file) { }
+
+        size_t read(void* data, size_t bytes) noexcept { return std::fread(data, 1, bytes, _file); }
+
+    private:
+        std::FILE* _file;
+    };
+
+    namespace detail {
+        // The number of bytes bit streams buffer between calls to their sink or source
+        constexpr size_t bit_stream_buffer_bytes = size_t(64) * 1024;
+    }
+
+    /**
+     * @brief Writes a continuous stream of bits of any width to a byte sink. Values are written starting at the least
+     * significant bit of each byte, so a stream of fields looks like one large little endian integer.
+     *
+     * Bits collect in a 64 bit accumulator that is stored to an internal buffer whenever it fills, and the buffer is
+     * passed to the sink in large chunks. Call flush() once done; the destructor also flushes, but an exception thrown by
+     * the sink there ends the program, so flush explicitly when the sink can throw.
+     *
+     * @tparam S The sink type
+     */
+    template<typename S>
+    class bit_writer {
+        // Writes only pass bytes on to the sink, so they throw exactly when the sink does (vector_sink can throw
+        // std::bad_alloc)
+        static constexpr bool _nothrow_sink = noexcept(std::declval<S&>().write(std::declval<const void*>(), size_t()));
+
+    public:
+        explicit bit_writer(S sink) : _sink(std::move(sink)), _buffer(detail::bit_stream_buffer_bytes) { }
+
+        bit_writer(const bit_writer&)            = delete;
+        bit_writer& operator=(const bit_writer&) = delete;
+
+        ~bit_writer() { flush(); }
+
+        /**
+         * @brief Writes the lowest width bits of value
+         *
+         * @param value The value
+         * @param width The number of bits to write, up to 64
+         */
+        void write(std::uint64_t value, size_t width) noexcept(_nothrow_sink) {
+            assert(width <= 64 && "bit_writer can write at most 64 bits at a time");
+            value &= detail::low_mask(width);
+            const size_t total = _bits + width;
+            _accumulator |= value << _bits;
+            if(total >= 64) {
+                _store(_accumulator);
+                // Two shifts so that a shift of 64 (when the accumulator was empty) yields 0
+                _accumulator = (value >> 1) >> (63 - _bits);
+            }
+            _bits = total & 63;
+            _written += width;
+        }
+
+        /**
+         * @brief Writes a value as a field of width W
+         *
+         * @tparam W The width of the field
+         * @param value The value
+         */
+        template<size_t W>
+        void write(std::uint64_t value) noexcept(_nothrow_sink) {
+            static_assert(W <= 64, "bit_writer can write at most 64 bits at a time");
+            assert((value & bitmask_v<std::uint64_t, W>) == value && "The value overflows the bitwidth being written");
+            write(value, W);
+        }
+
+        /**
+         * @brief Writes every field of a bitpack, using exactly the bits its fields span. This is the layout's total
+         * bitwidth unless the layout leaves gaps between fields, as an optimized_layout can.
+         *
+         * @param record The bitpack
+         */
+        template<typename L, template<storage_preference, size_t> typename D, overflow_policy O>
+        void write(const bitpack<L, D, O>& record) noexcept(_nothrow_sink) {
+            write(static_cast<std::uint64_t>(record.data()), detail::field_extent(L::field_sizes, L::field_offsets));
+        }
+
+        /**
+         * @brief Writes any partially filled byte and passes all buffered bytes to the sink. The stream is padded with
+         * zeros to the next byte boundary.
+         *
+         * @return true If the sink accepted every byte written so far
+         */
+        bool flush() noexcept(_nothrow_sink) {
+            if(_bits > 0) {
+                std::uint8_t tail[8];
+                detail::store_le64(tail, _accumulator);
+                const size_t bytes = (_bits + 7) / 8;
+                _flush_buffer();
+                _good        = _sink.write(tail, bytes) && _good;
+                _written     = (_written + 7) & ~size_t(7);
+                _accumulator = 0;
+                _bits        = 0;
+            }
+            _flush_buffer();
+            return _good;
+        }
+
+        /**
+         * @brief Gets the number of bits written, including padding added by flush()
+         *
+         */
+        size_t bits_written() const noexcept { return _written; }
+
+        /**
+         * @brief Gets whether the sink has accepted every byte written so far
+         *
+         */
+        bool good() const noexcept { return _good; }
+
+    private:
+        S _sink;
+        std::vector<std::uint8_t> _buffer;
+        size_t _used               = 0;
+        std::uint64_t _accumulator = 0;
+        size_t _bits               = 0;
+        size_t _written            = 0;
+        bool _good                 = true;
+
+        void _store(std::uint64_t word) noexcept(_nothrow_sink) {
+            detail::store_le64(_buffer.data() + _used, word);
+            _used += sizeof(word);
+            if(_used == _buffer.size()) {
+                _flush_buffer();
+            }
+        }
+
+        void _flush_buffer() noexcept(_nothrow_sink) {
+            if(_used > 0) {
+                _good = _sink.write(_buffer.data(), _used) && _good;
+                _used = 0;
+            }
+        }
+    };
+
+    /**
+     * @brief Reads a continuous stream of bits written by bit_writer from a byte source.
+     *
+     * Bytes are read from the source into an internal buffer in large chunks. A read loads the 8 bytes holding the
+     * requested bits and shifts them into place, with no loop or per byte branch; the only branch checks whether the
+     * buffer needs another chunk. Reading past the end of the stream yields zeros and clears good().
+     *
+     * @tparam S The source type
+     */
+    template<typename S>
+    class bit_reader {
+    public:
+        explicit bit_reader(S source) : _source(std::move(source)), _buffer(detail::bit_stream_buffer_bytes + padding) { }
+
+        /**
+         * @brief Reads width bits
+         *
+         * @param width The number of bits to read, up to 64
+         * @return std::uint64_t The value
+         */
+        std::uint64_t read(size_t width) noexcept {
+            assert(width <= 64 && "bit_reader can read at most 64 bits at a time");
+            // A single unaligned load covers at least 57 bits, so wider reads are split in two
+            if(width > 56) {
+                const std::uint64_t low = _read_bits(32);
+                return low | (_read_bits(width - 32) << 32);
+            }
+            return _read_bits(width);
+        }
+
+        /**
+         * @brief Reads a field of width W
+         *
+         * @tparam W The width of the field
+         * @return std::uint64_t The value
+         */
+        template<size_t W>
+        std::uint64_t read() noexcept {
+            static_assert(W <= 64, "bit_reader can read at most 64 bits at a time");
+            return read(W);
+        }
+
+        /**
+         * @brief Reads a bitpack written by bit_writer::write(record)
+         *
+         * @tparam P The bitpack type
+         * @return P The bitpack
+         */
+        template<typename P, typename = typename P::layout_type>
+        P read() noexcept {
+            using layout_type  = typename P::layout_type;
+            using storage_type = typename P::storage_type;
+            return P(static_cast<storage_type>(read(detail::field_extent(layout_type::field_sizes, layout_type::field_offsets))));
+        }
+
+        /**
+         * @brief Skips to the next byte boundary, matching the padding added by bit_writer::flush()
+         *
+         */
+        void align() noexcept { _position = (_position + 7) & ~size_t(7); }
+
+        /**
+         * @brief Gets the number of bits read
+         *
+         */
+        size_t bits_read() const noexcept { return _discarded * 8 + _position; }
+
+        /**
+         * @brief Gets whether every read so far was within the stream
+         *
+         */
+        bool good() const noexcept { return _good; }
+
+    private:
+        // Zeroed bytes past the valid data so a load near the end never reads outside the buffer
+        static constexpr size_t padding = 8;
+
+        S _source;
+        std::vector<std::uint8_t> _buffer;
+        size_t _valid     = 0;
+        size_t _position  = 0;
+        size_t _discarded = 0;
+        bool _good        = true;
+
+        std::uint64_t _read_bits(size_t width) noexcept {
+            if(_position + width > _valid * 8) {
+                _refill(width);
+            }
+            const std::uint64_t word = detail::load_le64(_buffer.data() + _position / 8) >> (_position % 8);
+            _position += width;
+            return word & detail::low_mask(width);
+        }
+
+        void _refill(size_t width) noexcept {
+            const size_t consumed = _position / 8;
+            const size_t kept     = _valid - std::min(consumed, _valid);
+            std::memmove(_buffer.data(), _buffer.data() + consumed, kept);
+            _position -= consumed * 8;
+            _discarded += consumed;
+            _valid = kept;
+
+            const size_t capacity = _buffer.size() - padding;
+            while(_valid < capacity) {
+                const size_t got = _source.read(_buffer.data() + _valid, capacity - _valid);
+                if(got == 0) {
+                    break;
+                }
+                _valid += got;
+            }
+            std::fill(_buffer.begin() + static_cast<std::ptrdiff_t>(_valid), _buffer.end(), std::uint8_t(0));
+            if(_position + width > _valid * 8) {
+                _good = false;
+            }
+        }
+    };
+}
+
+#endif
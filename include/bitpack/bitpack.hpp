@@ -30,7 +30,35 @@ SOFTWARE.
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <limits>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L
+#    include <compare>
+#endif
+
+#if defined(BITPACK_PROFILE_ACCESS)
+#    include <bitpack/access_profile.hpp>
+#endif
+
+// Whether the enclosing constexpr function is being evaluated at compile time, so side effects like counters can be
+// skipped there. C++17 has no standard way to ask, but the major compilers provide the builtin that C++20's
+// std::is_constant_evaluated is built on. Without either, this is always false and the side effects can't be used
+// in constant expressions.
+#if defined(__cpp_lib_is_constant_evaluated) && __cpp_lib_is_constant_evaluated >= 201811L
+#    define BITPACK_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__has_builtin)
+#    if __has_builtin(__builtin_is_constant_evaluated)
+#        define BITPACK_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#    endif
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#    define BITPACK_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#if !defined(BITPACK_IS_CONSTANT_EVALUATED)
+#    define BITPACK_IS_CONSTANT_EVALUATED() false
+#endif
 
 static_assert(__cplusplus >= 201703L, "C++ Standard must be at least C++17");
 
@@ -78,12 +106,27 @@ namespace bitpack {
         template<typename T>
         struct always_false : std::false_type { };
 
+        template<typename T>
+        struct is_integral_constant : std::false_type { };
+
+        template<typename T, T V>
+        struct is_integral_constant<std::integral_constant<T, V>> : std::true_type { };
+
         // Compile time alternative to std::accumulate (which is not constexpr until c++20)
         template<typename IT, typename T>
         constexpr T accumulate(IT first, IT last, T init) {
             for(; first != last; ++first) { init = std::move(init) + *first; }
             return init;
         }
+
+        // The number of low bits spanned by fields at the given offsets, which exceeds the total width when a layout
+        // leaves gaps between its fields
+        template<size_t N>
+        constexpr size_t field_extent(const std::array<size_t, N>& sizes, const std::array<size_t, N>& offsets) {
+            size_t extent = 0;
+            for(size_t i = 0; i < N; ++i) { extent = offsets[i] + sizes[i] > extent ? offsets[i] + sizes[i] : extent; }
+            return extent;
+        }
     }
 
     /**
@@ -98,7 +141,20 @@ namespace bitpack {
          * @brief The bitmask
          *
          */
-        static constexpr T value = (T(1) << (W)) - T(1);
+        static constexpr T value = [] {
+            // Shifting by the full width of an integral type is undefined, so a full width mask is built directly
+            if constexpr(std::is_integral_v<T>) {
+                if constexpr(W >= std::numeric_limits<T>::digits) {
+                    return T(~T(0));
+                }
+                else {
+                    return T((T(1) << (W)) - T(1));
+                }
+            }
+            else {
+                return (T(1) << (W)) - T(1);
+            }
+        }();
     };
 
     /**
@@ -114,16 +170,35 @@ namespace bitpack {
      * @brief Marker type for bitpack field widths
      *
      * @tparam W The number of bits in the field
+     * @tparam TAG An optional field_tag naming the field, used to match fields across layouts. Tags are constants rather
+     * than arbitrary types so that layout fingerprints don't depend on compiler-specific type names.
      */
-    template<size_t W>
+    template<size_t W, typename TAG = void>
     struct bitwidth {
+        static_assert(std::is_void_v<TAG> || detail::is_integral_constant<TAG>::value,
+                      "A field tag must be a field_tag<V> constant");
+
         /**
          * @brief The number of bits int he field
          *
          */
         static constexpr size_t width = W;
+
+        /**
+         * @brief The tag naming the field, or void if the field is untagged
+         *
+         */
+        using tag = TAG;
     };
 
+    /**
+     * @brief Tag type that names a field with a compile time constant, usually the enum value used to index it
+     *
+     * @tparam V The constant
+     */
+    template<auto V>
+    using field_tag = std::integral_constant<decltype(V), V>;
+
     /**
      * @brief Compile time check to test if a type is a specialization of bitwidth
      *
@@ -136,9 +211,10 @@ namespace bitpack {
      * @brief Compile time check to test if a type is a specialization of bitwidth
      *
      * @tparam W The width of the bitwidth
+     * @tparam TAG The tag of the bitwidth
      */
-    template<size_t W>
-    struct is_bitwidth<bitwidth<W>> : std::true_type { };
+    template<size_t W, typename TAG>
+    struct is_bitwidth<bitwidth<W, TAG>> : std::true_type { };
 
     /**
      * @brief Helper alias for is_bitwidth<T>::value
@@ -158,28 +234,184 @@ namespace bitpack {
     };
 
     /**
-     * @brief Layout type that determines the fields and their widths in a bitpack
+     * @brief Marker type used to designate where the first field of a layout is placed in storage
+     *
+     * LSB_FIRST places field 0 at bit 0, which is the default. MSB_FIRST places field 0 at the most significant bits so that
+     * comparing the raw storage of two bitpacks is the same as comparing their fields lexicographically.
+     */
+    enum class field_order {
+        LSB_FIRST,
+        MSB_FIRST
+    };
+
+    /**
+     * @brief Marker type used to designate what set does with a value that is too wide for its field
+     *
+     * ASSERT truncates the value after a debug assert, which is the default. TRUNCATE keeps only the low bits without
+     * checking. SATURATE stores the largest value the field holds instead. CHECKED leaves the field unchanged and makes
+     * set return false. COUNT truncates the value and increments the calling thread's overflow_count().
+     */
+    enum class overflow_policy {
+        ASSERT,
+        TRUNCATE,
+        SATURATE,
+        CHECKED,
+        COUNT
+    };
+
+    namespace detail {
+        // The number of values truncated by set on this thread, for bitpacks with the COUNT overflow policy
+        inline std::uint64_t& overflow_counter() noexcept {
+            thread_local std::uint64_t count = 0;
+            return count;
+        }
+    }
+
+    /**
+     * @brief Gets the number of values the calling thread has truncated in bitpacks with the COUNT overflow policy
+     *
+     * @return std::uint64_t The number of truncated values
+     */
+    inline std::uint64_t overflow_count() noexcept { return detail::overflow_counter(); }
+
+    /**
+     * @brief Resets the calling thread's overflow_count() to zero
+     *
+     */
+    inline void reset_overflow_count() noexcept { detail::overflow_counter() = 0; }
+
+    namespace detail {
+        // Computes the bit offset of each field given the field widths and the order the fields are placed in.
+        template<size_t N>
+        constexpr std::array<size_t, N> field_offsets(const std::array<size_t, N>& sizes, field_order order) {
+            std::array<size_t, N> offsets {};
+            const size_t total = detail::accumulate(sizes.begin(), sizes.end(), size_t(0));
+            size_t running     = 0;
+            for(size_t i = 0; i < N; ++i) {
+                running += sizes[i];
+                offsets[i] = order == field_order::LSB_FIRST ? running - sizes[i] : total - running;
+            }
+            return offsets;
+        }
+
+        /**
+         * @brief Converts an unknown index type I (Either enum or integral) to a size_t value.
+         *
+         * @tparam I The index
+         * @return constexpr size_t The converted index
+         */
+        template<auto I>
+        constexpr size_t index_to_sizet() {
+            static_assert(std::is_enum_v<decltype(I)> || std::is_integral_v<decltype(I)>, "Index must be numeric or enum type");
+            using index_type = decltype(I);
+            if constexpr(std::is_enum_v<index_type>) {
+                return static_cast<std::underlying_type_t<index_type>>(I);
+            }
+            else {
+                return I;
+            }
+        }
+    }
+
+    /**
+     * @brief Layout type that determines the fields, their widths, and their placement in a bitpack
      *
      * @tparam P The users preference for fast or small storage
+     * @tparam O The order fields are placed in storage
      * @tparam FIELDS The fields of the layout.
      */
-    template<storage_preference P, typename... FIELDS>
-    struct layout {
+    template<storage_preference P, field_order O, typename... FIELDS>
+    struct basic_layout {
         static_assert((is_bitwidth_v<FIELDS> && ... && true), "layout fields must be a bitwidth type.");
 
         /**
          * @brief The storage preference (fast or small)
          *
          */
-        static constexpr storage_preference storage_preference = P;
+        static constexpr ::bitpack::storage_preference storage_preference = P;
+
+        /**
+         * @brief The order fields are placed in storage
+         *
+         */
+        static constexpr ::bitpack::field_order field_order = O;
 
         /**
          * @brief The width in bits of each field in the layout
          *
          */
         static constexpr std::array<size_t, sizeof...(FIELDS)> field_sizes = { FIELDS::width... };
+
+        /**
+         * @brief The offset in bits of each field in the layout
+         *
+         */
+        static constexpr std::array<size_t, sizeof...(FIELDS)> field_offsets = detail::field_offsets(field_sizes, O);
+
+        /**
+         * @brief The tag of each field in the layout, void for untagged fields
+         *
+         */
+        using field_tags = std::tuple<typename FIELDS::tag...>;
+    };
+
+    /**
+     * @brief Gets the tag of field I of layout L, or void if the field is untagged or L doesn't declare field tags
+     *
+     * @tparam L The layout
+     * @tparam I The index of the field
+     */
+    template<typename L, size_t I, typename E = void>
+    struct layout_field_tag {
+        /**
+         * @brief The tag
+         *
+         */
+        using type = void;
     };
 
+    /**
+     * @brief Gets the tag of field I of layout L, or void if the field is untagged or L doesn't declare field tags
+     *
+     * @tparam L The layout
+     * @tparam I The index of the field
+     */
+    template<typename L, size_t I>
+    struct layout_field_tag<L, I, std::void_t<typename L::field_tags>> {
+        /**
+         * @brief The tag
+         *
+         */
+        using type = std::tuple_element_t<I, typename L::field_tags>;
+    };
+
+    /**
+     * @brief Helper alias for layout_field_tag<L, I>::type
+     *
+     * @tparam L The layout
+     * @tparam I The index of the field
+     */
+    template<typename L, size_t I>
+    using layout_field_tag_t = typename layout_field_tag<L, I>::type;
+
+    /**
+     * @brief Layout type that places field 0 at the least significant bits
+     *
+     * @tparam P The users preference for fast or small storage
+     * @tparam FIELDS The fields of the layout.
+     */
+    template<storage_preference P, typename... FIELDS>
+    struct layout : basic_layout<P, field_order::LSB_FIRST, FIELDS...> { };
+
+    /**
+     * @brief Layout type that places field 0 at the most significant bits, so raw storage compares like the field tuple
+     *
+     * @tparam P The users preference for fast or small storage
+     * @tparam FIELDS The fields of the layout.
+     */
+    template<storage_preference P, typename... FIELDS>
+    struct sortable_layout : basic_layout<P, field_order::MSB_FIRST, FIELDS...> { };
+
     /**
      * @brief Alias for a bitpack layout with a fast storage preference
      *
@@ -196,6 +428,22 @@ namespace bitpack {
     template<typename... FIELDS>
     using small_layout = layout<storage_preference::SMALL, FIELDS...>;
 
+    /**
+     * @brief Alias for a sortable bitpack layout with a fast storage preference
+     *
+     * @tparam FIELDS The fields of the layout
+     */
+    template<typename... FIELDS>
+    using fast_sortable_layout = sortable_layout<storage_preference::FAST, FIELDS...>;
+
+    /**
+     * @brief Alias for a sortable bitpack layout with a small storage preference
+     *
+     * @tparam FIELDS The fields of the layout
+     */
+    template<typename... FIELDS>
+    using small_sortable_layout = sortable_layout<storage_preference::SMALL, FIELDS...>;
+
     namespace detail {
         /*
 
@@ -278,41 +526,48 @@ namespace bitpack {
      * @tparam D The storage detector
      */
     template<typename T, template<storage_preference, size_t> typename D = layout_storage_detector>
-    struct layout_traits;
-
-    /**
-     * @brief Trait implementation for all types
-     *
-     * @tparam P The user's storage_preference
-     * @tparam D The storage detector
-     * @tparam FIELDS The fields in the layout
-     */
-    template<storage_preference P, template<storage_preference, size_t> typename D, typename... FIELDS>
-    struct layout_traits<layout<P, FIELDS...>, D> {
+    struct layout_traits {
         /**
          * @brief The total number of bits requried by the layout
          *
          */
-        static constexpr size_t total_bitwidth = (FIELDS::width + ... + 0);
+        static constexpr size_t total_bitwidth = detail::accumulate(T::field_sizes.begin(), T::field_sizes.end(), size_t(0));
 
         /**
          * @brief The type used to store all of the bits in the bitpack
          *
          */
-        using storage_type = typename D<P, total_bitwidth>::type;
+        using storage_type = typename D<T::storage_preference, total_bitwidth>::type;
 
         static_assert(sizeof(storage_type) * CHAR_BIT >= total_bitwidth, "The storage type is not able to store enough bits");
     };
 
-    template<typename L, template<storage_preference, size_t> typename D = layout_storage_detector>
+    template<typename L,
+             template<storage_preference, size_t> typename D = layout_storage_detector,
+             overflow_policy O                                = overflow_policy::ASSERT>
     struct bitpack {
     public:
+        /**
+         * @brief The layout of the bitpack
+         *
+         */
+        using layout_type = L;
+
+        /**
+         * @brief What set does with a value that is too wide for its field
+         *
+         */
+        static constexpr ::bitpack::overflow_policy overflow_policy = O;
+
         /**
          * @brief The type used to store data
          *
          */
         using storage_type = typename layout_traits<L, D>::storage_type;
 
+        static_assert(detail::field_extent(L::field_sizes, L::field_offsets) <= sizeof(storage_type) * CHAR_BIT,
+                      "The layout places fields beyond the bits of the storage type");
+
     private:
         /**
          * @brief The actual data stored by the bitpack
@@ -321,32 +576,77 @@ namespace bitpack {
         storage_type _data = 0;
 
         /**
-         * @brief Converts an unknown index type I (Either enum or integral) to a size_t value.
+         * @brief Uses the layout_storage_detector to determine the storage type that should be used at index I
          *
          * @tparam I The index
-         * @return constexpr size_t The converted index
          */
         template<auto I>
-        static constexpr size_t _index_to_sizet() {
-            static_assert(std::is_enum_v<decltype(I)> || std::is_integral_v<decltype(I)>, "Index must be numeric or enum type");
-            using index_type = decltype(I);
-            if constexpr(std::is_enum_v<index_type>) {
-                return static_cast<std::underlying_type_t<index_type>>(I);
-            }
-            else {
-                return I;
-            }
-        }
+        using storage_at =
+            typename layout_storage_detector<L::storage_preference, L::field_sizes[detail::index_to_sizet<I>()]>::type;
 
         /**
-         * @brief Uses the layout_storage_detector to determine the storage type that should be used at index I
+         * @brief Moves every field from its position in L to its position in an MSB_FIRST layout with the same fields
          *
-         * @tparam I The index
+         * @return constexpr storage_type The rearranged storage
          */
-        template<auto I>
-        using storage_at = typename layout_storage_detector<L::storage_preference, L::field_sizes[_index_to_sizet<I>()]>::type;
+        template<size_t... Is>
+        constexpr storage_type _to_msb_first(std::index_sequence<Is...>) const noexcept {
+            constexpr auto msb_offsets = detail::field_offsets(L::field_sizes, field_order::MSB_FIRST);
+            return (storage_type(0) | ... |
+                    (((_data >> L::field_offsets[Is]) & bitmask_v<storage_type, L::field_sizes[Is]>) << msb_offsets[Is]));
+        }
 
     public:
+        /**
+         * @brief Constructs a bitpack with all fields set to zero
+         *
+         */
+        constexpr bitpack() noexcept = default;
+
+        /**
+         * @brief Constructs a bitpack directly from its raw storage. Bits not covered by a field are expected to be zero.
+         *
+         * @param data The raw storage
+         */
+        explicit constexpr bitpack(storage_type data) noexcept : _data(data) { }
+
+        /**
+         * @brief Gets the raw storage of the bitpack
+         *
+         * @return constexpr storage_type The raw storage
+         */
+        constexpr storage_type data() const noexcept { return _data; }
+
+        /**
+         * @brief Gets a key whose integer ordering matches the lexicographic ordering of the fields (field 0 first).
+         * For MSB_FIRST layouts this is the raw storage itself.
+         *
+         * @return constexpr storage_type The sort key
+         */
+        constexpr storage_type to_sort_key() const noexcept {
+            if constexpr(L::field_order == field_order::MSB_FIRST) {
+                return _data;
+            }
+            else {
+                return _to_msb_first(std::make_index_sequence<L::field_sizes.size()>());
+            }
+        }
+
+        friend constexpr bool operator==(const bitpack& lhs, const bitpack& rhs) noexcept { return lhs._data == rhs._data; }
+        friend constexpr bool operator!=(const bitpack& lhs, const bitpack& rhs) noexcept { return lhs._data != rhs._data; }
+        friend constexpr bool operator<(const bitpack& lhs, const bitpack& rhs) noexcept {
+            return lhs.to_sort_key() < rhs.to_sort_key();
+        }
+        friend constexpr bool operator>(const bitpack& lhs, const bitpack& rhs) noexcept { return rhs < lhs; }
+        friend constexpr bool operator<=(const bitpack& lhs, const bitpack& rhs) noexcept { return !(rhs < lhs); }
+        friend constexpr bool operator>=(const bitpack& lhs, const bitpack& rhs) noexcept { return !(lhs < rhs); }
+
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L
+        friend constexpr std::strong_ordering operator<=>(const bitpack& lhs, const bitpack& rhs) noexcept {
+            return lhs.to_sort_key() <=> rhs.to_sort_key();
+        }
+#endif
+
         /**
          * @brief Gets the value stored in the bitpack at field index I
          *
@@ -356,31 +656,124 @@ namespace bitpack {
          */
         template<auto I, typename R = storage_at<I>>
         constexpr R get() const noexcept {
-            constexpr size_t index        = _index_to_sizet<I>();
+            constexpr size_t index        = detail::index_to_sizet<I>();
             constexpr auto unshifted_mask = bitmask_v<storage_type, L::field_sizes[index]>;
-            constexpr auto shift = detail::accumulate(L::field_sizes.begin(), L::field_sizes.begin() + index, storage_type(0));
+            constexpr size_t shift        = L::field_offsets[index];
             constexpr storage_type mask = unshifted_mask << shift;
-            return (_data & mask) >> shift;
+#if defined(BITPACK_PROFILE_ACCESS)
+            if(!BITPACK_IS_CONSTANT_EVALUATED()) {
+                detail::record_access<L>(index, detail::access_kind::GET);
+            }
+#endif
+            // Integer promotion makes the expression an int for narrow storage, so narrow it back explicitly
+            return static_cast<R>((_data & mask) >> shift);
         }
 
         /**
-         * @brief Sets the data at bitpack field index I
+         * @brief Sets the data at bitpack field index I. A value too wide for the field is handled by the bitpack's
+         * overflow policy.
          *
          * @tparam I The index of the data being accessed
          * @param value The value of the data at field I
+         * @return bool With the CHECKED policy, false if the value didn't fit and the field was left unchanged. Other
+         * policies return void.
+         */
+        template<auto I>
+        constexpr std::conditional_t<O == overflow_policy::CHECKED, bool, void> set(storage_at<I> value) noexcept {
+            constexpr size_t index        = detail::index_to_sizet<I>();
+            constexpr auto unshifted_mask = bitmask_v<storage_type, L::field_sizes[index]>;
+            constexpr size_t shift        = L::field_offsets[index];
+            constexpr storage_type mask = unshifted_mask << shift;
+
+            if constexpr(O == overflow_policy::ASSERT) {
+                // Debug check to make sure that data isn't overflowing
+                assert((value & unshifted_mask) == value &&
+                       "The input value overflows the bitwidth associated with the provided index");
+            }
+            else if constexpr(O == overflow_policy::SATURATE) {
+                value = value < unshifted_mask ? value : static_cast<storage_at<I>>(unshifted_mask);
+            }
+#if defined(BITPACK_PROFILE_ACCESS)
+            if(!BITPACK_IS_CONSTANT_EVALUATED()) {
+                detail::record_access<L>(index, detail::access_kind::SET);
+            }
+#endif
+            if constexpr(O == overflow_policy::CHECKED) {
+                // The field is only written through a mask that is empty when the value doesn't fit, so a failed set
+                // costs no branch
+                const bool fits               = (value & unshifted_mask) == value;
+                const storage_type write_mask = mask & storage_type(storage_type(0) - storage_type(fits));
+                _data                         = (_data & ~write_mask) | (((value & unshifted_mask) << shift) & write_mask);
+                return fits;
+            }
+            else {
+                if constexpr(O == overflow_policy::COUNT) {
+                    if(!BITPACK_IS_CONSTANT_EVALUATED()) {
+                        detail::overflow_counter() += static_cast<std::uint64_t>((value & unshifted_mask) != value);
+                    }
+                }
+                _data &= ~mask;
+                _data |= (value & unshifted_mask) << shift;
+            }
+        }
+
+        /**
+         * @brief Adds to the data at bitpack field index I in place, wrapping around within the field
+         *
+         * @tparam I The index of the data being accessed
+         * @param delta The amount to add. Only its low bits, up to the width of the field, matter.
          */
         template<auto I>
-        constexpr void set(storage_at<I> value) noexcept {
-            constexpr size_t index        = _index_to_sizet<I>();
+        constexpr void add(storage_at<I> delta) noexcept {
+            constexpr size_t index        = detail::index_to_sizet<I>();
             constexpr auto unshifted_mask = bitmask_v<storage_type, L::field_sizes[index]>;
-            constexpr auto shift = detail::accumulate(L::field_sizes.begin(), L::field_sizes.begin() + index, storage_type(0));
+            constexpr size_t shift        = L::field_offsets[index];
             constexpr storage_type mask = unshifted_mask << shift;
+#if defined(BITPACK_PROFILE_ACCESS)
+            if(!BITPACK_IS_CONSTANT_EVALUATED()) {
+                detail::record_access<L>(index, detail::access_kind::SET);
+            }
+#endif
+            const auto sum = static_cast<storage_type>(_data + storage_type(storage_type(delta & unshifted_mask) << shift));
+            // A field at the top of storage carries out of storage, anywhere else the carry is masked off
+            if constexpr(shift + L::field_sizes[index] == sizeof(storage_type) * CHAR_BIT) {
+                _data = sum;
+            }
+            else {
+                _data = (_data & ~mask) | (sum & mask);
+            }
+        }
+
+        /**
+         * @brief Adds one to the data at bitpack field index I in place, wrapping around to zero
+         *
+         * @tparam I The index of the data being accessed
+         */
+        template<auto I>
+        constexpr void increment() noexcept {
+            add<I>(1);
+        }
 
-            // Debug check to make sure that data isn't overflowing
-            assert((value & unshifted_mask) == value &&
-                   "The input value overflows the bitwidth associated with the provided index");
-            _data &= ~mask;
-            _data |= (value & unshifted_mask) << shift;
+        /**
+         * @brief Adds to the data at bitpack field index I in place, stopping at the largest value the field holds
+         *
+         * @tparam I The index of the data being accessed
+         * @param delta The amount to add
+         */
+        template<auto I>
+        constexpr void saturating_add(storage_at<I> delta) noexcept {
+            constexpr size_t index        = detail::index_to_sizet<I>();
+            constexpr auto unshifted_mask = bitmask_v<storage_type, L::field_sizes[index]>;
+            constexpr size_t shift        = L::field_offsets[index];
+#if defined(BITPACK_PROFILE_ACCESS)
+            if(!BITPACK_IS_CONSTANT_EVALUATED()) {
+                detail::record_access<L>(index, detail::access_kind::SET);
+            }
+#endif
+            // Clamping delta to the room left in the field means the add can never carry, and the clamp is a select
+            const storage_type room    = unshifted_mask - ((_data >> shift) & unshifted_mask);
+            const storage_type clamped = static_cast<storage_type>(delta) < room ? static_cast<storage_type>(delta) : room;
+            _data = static_cast<storage_type>(_data + storage_type(clamped << shift));
         }
     };
 }
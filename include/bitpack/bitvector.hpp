@@ -0,0 +1,319 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_BITVECTOR_HPP
+#define BITPACK_BITVECTOR_HPP
+
+#include <algorithm>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief A bitvector with constant time rank and near constant time select.
+     *
+     * After build(), a directory in the style of poppy (Zhou et al.) holds one 64 bit entry per 2048 bits: the number of
+     * set bits before it, and the set bit counts of its first three 512 bit sub-blocks. That is 3.125% on top of the bits,
+     * plus one select sample per 8192 set (or clear) bits. rank() reads one entry and at most eight words. select() starts
+     * from the nearest sample, binary searches the entries, and finishes within one word.
+     *
+     * As a presence index for a sparse field, row i has a value when get(i) is true, and that value is stored at index
+     * rank1(i) of a dense array holding only the present values.
+     */
+    class packed_bitvector {
+    public:
+        packed_bitvector() = default;
+
+        /**
+         * @brief Creates a bitvector of n bits, all set to value
+         *
+         */
+        explicit packed_bitvector(size_t n, bool value = false)
+            : _size(n), _words((n + 63) / 64, value ? ~std::uint64_t(0) : 0) {
+            _clear_padding();
+            build();
+        }
+
+        /**
+         * @brief Creates a bitvector from the first n bits of an array of words, lowest bit first
+         *
+         */
+        packed_bitvector(const std::uint64_t* words, size_t n) : _size(n), _words(words, words + (n + 63) / 64) {
+            _clear_padding();
+            build();
+        }
+
+        /**
+         * @brief Appends a bit. The rank and select directory is out of date until build() is called.
+         *
+         */
+        void push_back(bool bit) {
+            if(_size % 64 == 0) {
+                _words.push_back(0);
+            }
+            _words.back() |= std::uint64_t(bit) << (_size % 64);
+            ++_size;
+            _built = false;
+        }
+
+        /**
+         * @brief Sets bit i. The rank and select directory is out of date until build() is called.
+         *
+         */
+        void set(size_t i, bool bit = true) noexcept {
+            assert(i < _size && "Bit out of range");
+            const std::uint64_t mask = std::uint64_t(1) << (i % 64);
+            _words[i / 64]           = bit ? _words[i / 64] | mask : _words[i / 64] & ~mask;
+            _built                   = false;
+        }
+
+        /**
+         * @brief Gets bit i
+         *
+         */
+        bool get(size_t i) const noexcept {
+            assert(i < _size && "Bit out of range");
+            return (_words[i / 64] >> (i % 64)) & 1;
+        }
+
+        bool operator[](size_t i) const noexcept { return get(i); }
+
+        /**
+         * @brief Gets the number of bits
+         *
+         */
+        size_t size() const noexcept { return _size; }
+
+        bool empty() const noexcept { return _size == 0; }
+
+        /**
+         * @brief Gets the number of set bits. Requires an up to date directory.
+         *
+         */
+        size_t count() const noexcept {
+            assert(_built && "Call build() after modifying the bitvector");
+            return _ones;
+        }
+
+        /**
+         * @brief Gets the words holding the bits, lowest bit first. Bits past size() are zero.
+         *
+         */
+        const std::uint64_t* data() const noexcept { return _words.data(); }
+        size_t word_count() const noexcept { return _words.size(); }
+
+        /**
+         * @brief Rebuilds the rank and select directory
+         *
+         */
+        void build() {
+            const size_t blocks = (_words.size() + block_words - 1) / block_words;
+            _blocks.assign(blocks + 1, 0);
+            _regions.assign(((blocks * block_bits) >> region_shift) + 1, 0);
+            _ones_samples.clear();
+            _zeros_samples.clear();
+            // Samples store block indices in 32 bits
+            assert(blocks <= std::numeric_limits<std::uint32_t>::max() && "The bitvector has too many blocks to sample");
+
+            size_t ones = 0;
+            for(size_t b = 0; b <= blocks; ++b) {
+                const size_t region = (b * block_bits) >> region_shift;
+                if(((b * block_bits) & detail::low_mask(region_shift)) == 0) {
+                    _regions[region] = ones;
+                }
+                std::uint64_t entry = ones - _regions[region];
+                if(b < blocks) {
+                    size_t block_ones = 0;
+                    for(size_t s = 0; s < sub_blocks; ++s) {
+                        const size_t sub_ones = _popcount(b * block_words + s * sub_words, sub_words);
+                        if(s + 1 < sub_blocks) {
+                            entry |= std::uint64_t(sub_ones) << (32 + 10 * s);
+                        }
+                        block_ones += sub_ones;
+                    }
+                    // Samples record the block holding every sample_rate-th set and clear bit
+                    const size_t zeros = b * block_bits - ones;
+                    const auto block = static_cast<std::uint32_t>(b);
+                    while(_ones_samples.size() * sample_rate < ones + block_ones) { _ones_samples.push_back(block); }
+                    while(_zeros_samples.size() * sample_rate < zeros + block_bits - block_ones) {
+                        _zeros_samples.push_back(block);
+                    }
+                    ones += block_ones;
+                }
+                _blocks[b] = entry;
+            }
+            _ones  = ones;
+            _built = true;
+        }
+
+        /**
+         * @brief Counts the set bits before position i
+         *
+         * @param i A position from 0 to size()
+         * @return size_t The number of set bits in [0, i)
+         */
+        size_t rank1(size_t i) const noexcept {
+            assert(_built && "Call build() after modifying the bitvector");
+            assert(i <= _size && "Rank position out of range");
+            const size_t b            = i / block_bits;
+            const std::uint64_t entry = _blocks[b];
+            const size_t sub          = (i % block_bits) / sub_bits;
+            size_t rank               = _block_rank(b);
+            for(size_t s = 0; s < sub; ++s) { rank += (entry >> (32 + 10 * s)) & 0x3FF; }
+            const size_t first = b * block_words + sub * sub_words;
+            rank += _popcount(first, i / 64 - first);
+            if(i % 64 != 0) {
+                rank += detail::popcount(_words[i / 64] & detail::low_mask(i % 64));
+            }
+            return rank;
+        }
+
+        /**
+         * @brief Counts the clear bits before position i
+         *
+         */
+        size_t rank0(size_t i) const noexcept { return i - rank1(i); }
+
+        /**
+         * @brief Finds the set bit with k set bits before it
+         *
+         * @param k Less than count()
+         * @return size_t The position of the bit
+         */
+        size_t select1(size_t k) const noexcept {
+            assert(_built && "Call build() after modifying the bitvector");
+            assert(k < _ones && "Select rank out of range");
+            return _select<true>(k);
+        }
+
+        /**
+         * @brief Finds the clear bit with k clear bits before it
+         *
+         * @param k Less than size() - count()
+         * @return size_t The position of the bit
+         */
+        size_t select0(size_t k) const noexcept {
+            assert(_built && "Call build() after modifying the bitvector");
+            assert(k < _size - _ones && "Select rank out of range");
+            return _select<false>(k);
+        }
+
+        /**
+         * @brief Gets the number of bytes used by the bits and the directory
+         *
+         */
+        size_t size_in_bytes() const noexcept {
+            return _words.size() * sizeof(std::uint64_t) + _blocks.size() * sizeof(std::uint64_t) +
+                   _regions.size() * sizeof(size_t) + (_ones_samples.size() + _zeros_samples.size()) * sizeof(std::uint32_t);
+        }
+
+    private:
+        static constexpr size_t block_bits   = 2048;
+        static constexpr size_t block_words  = block_bits / 64;
+        static constexpr size_t sub_blocks   = 4;
+        static constexpr size_t sub_bits     = block_bits / sub_blocks;
+        static constexpr size_t sub_words    = sub_bits / 64;
+        static constexpr size_t sample_rate  = 8192;
+        // Block entries count set bits relative to the start of their 2^32 bit region
+        static constexpr size_t region_shift = 32;
+
+        size_t _size = 0;
+        size_t _ones = 0;
+        bool _built  = true;
+        std::vector<std::uint64_t> _words;
+        std::vector<std::uint64_t> _blocks;
+        std::vector<size_t> _regions;
+        std::vector<std::uint32_t> _ones_samples;
+        std::vector<std::uint32_t> _zeros_samples;
+
+        void _clear_padding() noexcept {
+            if(_size % 64 != 0) {
+                _words.back() &= detail::low_mask(_size % 64);
+            }
+        }
+
+        size_t _popcount(size_t first, size_t count) const noexcept {
+            const size_t last = std::min(first + count, _words.size());
+            size_t ones       = 0;
+            for(size_t w = first; w < last; ++w) { ones += detail::popcount(_words[w]); }
+            return ones;
+        }
+
+        size_t _block_rank(size_t b) const noexcept {
+            return _regions[(b * block_bits) >> region_shift] + static_cast<size_t>(_blocks[b] & 0xFFFFFFFF);
+        }
+
+        template<bool ONES>
+        size_t _count_before(size_t b) const noexcept {
+            return ONES ? _block_rank(b) : b * block_bits - _block_rank(b);
+        }
+
+        template<bool ONES>
+        size_t _select(size_t k) const noexcept {
+            const std::vector<std::uint32_t>& samples = ONES ? _ones_samples : _zeros_samples;
+            const size_t sample = k / sample_rate;
+
+            // The block lies between this sample's block and the next one's
+            size_t lo = samples[sample];
+            size_t hi = sample + 1 < samples.size() ? samples[sample + 1] : _blocks.size() - 2;
+            while(lo < hi) {
+                const size_t mid = lo + (hi - lo + 1) / 2;
+                if(_count_before<ONES>(mid) <= k) {
+                    lo = mid;
+                }
+                else {
+                    hi = mid - 1;
+                }
+            }
+
+            const size_t b            = lo;
+            const std::uint64_t entry = _blocks[b];
+            k -= _count_before<ONES>(b);
+            size_t sub = 0;
+            for(; sub + 1 < sub_blocks; ++sub) {
+                const size_t sub_ones = (entry >> (32 + 10 * sub)) & 0x3FF;
+                const size_t found    = ONES ? sub_ones : sub_bits - sub_ones;
+                if(k < found) {
+                    break;
+                }
+                k -= found;
+            }
+
+            for(size_t w = b * block_words + sub * sub_words;; ++w) {
+                const std::uint64_t word = ONES ? _words[w] : ~_words[w];
+                const size_t found       = detail::popcount(word);
+                if(k < found) {
+                    return w * 64 + detail::select_in_word(word, k);
+                }
+                k -= found;
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,203 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_BULK_HPP
+#define BITPACK_BULK_HPP
+
+#include <bitpack/bitpack.hpp>
+#include <bitpack/thread_pool.hpp>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if defined(BITPACK_USE_STD_EXECUTION)
+#    include <algorithm>
+#    include <execution>
+#    include <numeric>
+#    include <vector>
+#endif
+
+namespace bitpack {
+    namespace detail {
+        // Parallel bulk operations split their input into chunks of roughly this many bytes of packed output
+        constexpr size_t bulk_chunk_bytes = size_t(256) * 1024;
+
+        template<typename P>
+        constexpr size_t bulk_grain() noexcept {
+            return bulk_chunk_bytes / sizeof(P) > 0 ? bulk_chunk_bytes / sizeof(P) : 1;
+        }
+
+        template<typename R>
+        using range_value_t = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(std::declval<R&>()))>>;
+
+        /**
+         * @brief Packs rows [first, last) from one column per field into out
+         *
+         */
+        template<typename P, size_t... Is, typename... T>
+        void pack_rows(P* out, size_t first, size_t last, std::index_sequence<Is...>, const T*... columns) noexcept {
+            using storage_type = typename P::storage_type;
+            using layout_type  = typename P::layout_type;
+            for(size_t i = first; i < last; ++i) {
+                assert((((static_cast<storage_type>(columns[i]) & bitmask_v<storage_type, layout_type::field_sizes[Is]>) ==
+                         static_cast<storage_type>(columns[i])) &&
+                        ...) &&
+                       "The input value overflows the bitwidth associated with its column");
+                out[i] = P((storage_type(0) | ... |
+                            ((static_cast<storage_type>(columns[i]) & bitmask_v<storage_type, layout_type::field_sizes[Is]>)
+                             << layout_type::field_offsets[Is])));
+            }
+        }
+
+        /**
+         * @brief Unpacks field I of rows [first, last) into out
+         *
+         */
+        template<auto I, typename P, typename T>
+        void unpack_rows(const P* in, size_t first, size_t last, T* out) noexcept {
+            for(size_t i = first; i < last; ++i) {
+                out[i] = static_cast<T>(in[i].template get<I>());
+            }
+        }
+    }
+
+    /**
+     * @brief Packs one column per field into a contiguous range of bitpacks. Row i of every column goes into out[i].
+     *
+     * @param out The bitpacks being written
+     * @param columns One contiguous range per field of the layout, in field order, each at least as long as out
+     */
+    template<typename R, typename... COLUMNS>
+    void pack_columns(R&& out, const COLUMNS&... columns) {
+        using pack_type = detail::range_value_t<R>;
+        static_assert(sizeof...(COLUMNS) == pack_type::layout_type::field_sizes.size(), "Expected one column per field");
+        assert(((std::size(columns) >= std::size(out)) && ... && true) && "A column is shorter than the output");
+        detail::pack_rows(std::data(out), 0, std::size(out), std::index_sequence_for<COLUMNS...>(), std::data(columns)...);
+    }
+
+    /**
+     * @brief Unpacks field I of a contiguous range of bitpacks into a column. in[i] goes into out[i].
+     *
+     * @tparam I The index of the field
+     * @param in The bitpacks being read
+     * @param out The column being written, at least as long as in
+     */
+    template<auto I, typename R, typename C>
+    void unpack_column(const R& in, C&& out) {
+        assert(std::size(out) >= std::size(in) && "The column is shorter than the input");
+        detail::unpack_rows<I>(std::data(in), 0, std::size(in), std::data(out));
+    }
+
+    /**
+     * @brief Parallel version of pack_columns that runs cache sized chunks on a work stealing pool.
+     * Every row is written to the same position as the serial version, regardless of which thread packs it.
+     *
+     * @param pool The pool to run on
+     * @param out The bitpacks being written
+     * @param columns One contiguous range per field of the layout, in field order, each at least as long as out
+     */
+    template<typename R, typename... COLUMNS>
+    void parallel_pack_columns(work_stealing_pool& pool, R&& out, const COLUMNS&... columns) {
+        using pack_type = detail::range_value_t<R>;
+        static_assert(sizeof...(COLUMNS) == pack_type::layout_type::field_sizes.size(), "Expected one column per field");
+        assert(((std::size(columns) >= std::size(out)) && ... && true) && "A column is shorter than the output");
+        pack_type* const dst = std::data(out);
+        pool.parallel_for(std::size(out), detail::bulk_grain<pack_type>(), [&](size_t first, size_t last) {
+            detail::pack_rows(dst, first, last, std::index_sequence_for<COLUMNS...>(), std::data(columns)...);
+        });
+    }
+
+    /**
+     * @brief Parallel version of unpack_column that runs cache sized chunks on a work stealing pool
+     *
+     * @tparam I The index of the field
+     * @param pool The pool to run on
+     * @param in The bitpacks being read
+     * @param out The column being written, at least as long as in
+     */
+    template<auto I, typename R, typename C>
+    void parallel_unpack_column(work_stealing_pool& pool, const R& in, C&& out) {
+        using pack_type = detail::range_value_t<const R>;
+        assert(std::size(out) >= std::size(in) && "The column is shorter than the input");
+        const pack_type* const src = std::data(in);
+        auto* const dst            = std::data(out);
+        pool.parallel_for(std::size(in), detail::bulk_grain<pack_type>(), [&](size_t first, size_t last) {
+            detail::unpack_rows<I>(src, first, last, dst);
+        });
+    }
+
+#if defined(BITPACK_USE_STD_EXECUTION)
+    namespace detail {
+        // Runs fn(first, last) over cache sized chunks of [0, n) with a standard execution policy
+        template<typename E, typename F>
+        void for_each_chunk(E&& policy, size_t n, size_t grain, F&& fn) {
+            std::vector<size_t> chunks((n + grain - 1) / grain);
+            std::iota(chunks.begin(), chunks.end(), size_t(0));
+            std::for_each(std::forward<E>(policy), chunks.begin(), chunks.end(), [&](size_t c) {
+                fn(c * grain, (c + 1) * grain < n ? (c + 1) * grain : n);
+            });
+        }
+    }
+
+    /**
+     * @brief Parallel version of pack_columns that runs cache sized chunks with a standard execution policy such as
+     * std::execution::par. Only available when BITPACK_USE_STD_EXECUTION is defined.
+     *
+     */
+    template<typename E,
+             typename R,
+             typename... COLUMNS,
+             typename = std::enable_if_t<std::is_execution_policy_v<std::remove_cv_t<std::remove_reference_t<E>>>>>
+    void parallel_pack_columns(E&& policy, R&& out, const COLUMNS&... columns) {
+        using pack_type = detail::range_value_t<R>;
+        static_assert(sizeof...(COLUMNS) == pack_type::layout_type::field_sizes.size(), "Expected one column per field");
+        pack_type* const dst = std::data(out);
+        const auto pack = [&](size_t first, size_t last) {
+            detail::pack_rows(dst, first, last, std::index_sequence_for<COLUMNS...>(), std::data(columns)...);
+        };
+        detail::for_each_chunk(std::forward<E>(policy), std::size(out), detail::bulk_grain<pack_type>(), pack);
+    }
+
+    /**
+     * @brief Parallel version of unpack_column that runs cache sized chunks with a standard execution policy such as
+     * std::execution::par. Only available when BITPACK_USE_STD_EXECUTION is defined.
+     *
+     */
+    template<auto I,
+             typename E,
+             typename R,
+             typename C,
+             typename = std::enable_if_t<std::is_execution_policy_v<std::remove_cv_t<std::remove_reference_t<E>>>>>
+    void parallel_unpack_column(E&& policy, const R& in, C&& out) {
+        using pack_type            = detail::range_value_t<const R>;
+        const pack_type* const src = std::data(in);
+        auto* const dst            = std::data(out);
+        const auto unpack = [&](size_t first, size_t last) { detail::unpack_rows<I>(src, first, last, dst); };
+        detail::for_each_chunk(std::forward<E>(policy), std::size(in), detail::bulk_grain<pack_type>(), unpack);
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,499 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_COLUMNAR_FILE_HPP
+#define BITPACK_COLUMNAR_FILE_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <bitpack/for_codec.hpp>
+#include <bitpack/layout_fingerprint.hpp>
+#include <bitpack/mmap_packed_array.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief How a columnar file is read
+     *
+     * MMAP maps the file and decodes columns in place. PREAD keeps only the header and zone maps in memory and reads each
+     * column block with pread when a scan needs it.
+     */
+    enum class columnar_access {
+        MMAP,
+        PREAD
+    };
+
+    /**
+     * @brief Statistics gathered by a columnar_file scan
+     *
+     */
+    struct scan_stats {
+        size_t blocks_scanned = 0;
+        size_t blocks_skipped = 0;
+        size_t bytes_scanned  = 0;
+        size_t bytes_skipped  = 0;
+    };
+
+    namespace detail {
+        /*
+
+            Columnar files store the rows of a layout one column at a time, in blocks of BLOCK_ROWS rows. All header
+            fields are little endian:
+
+                0   char[8]   magic "BPCOLS02"
+                8   uint64    number of rows
+                16  uint32    rows per block
+                20  uint16    number of fields
+                24  uint64    schema fingerprint (see columnar_file_schema)
+                32  uint16[]  width of each field, in field order
+
+            As with packed record files, readers only compare the schema fingerprint.
+
+            The header is padded to a 64 byte boundary and followed by the zone maps: for each block, the minimum and
+            maximum of each field as uint64 pairs. The column data follows at the next 64 byte boundary. Each block holds
+            every field in field order, and each field is packed at its layout width, so the position of any column block
+            can be computed from the widths alone. The last block is padded with zeros.
+
+        */
+
+        constexpr char columnar_file_magic[8]     = { 'B', 'P', 'C', 'O', 'L', 'S', '0', '2' };
+        constexpr size_t columnar_file_fixed_bytes = 32;
+        constexpr size_t columnar_file_align       = 64;
+
+        /**
+         * @brief The schema fingerprint of a columnar file for layout L. It extends the layout fingerprint with the block
+         * size and byte order, so that one compare validates the whole header.
+         *
+         */
+        template<typename L, size_t BLOCK_ROWS>
+        constexpr std::uint64_t columnar_file_schema() noexcept {
+            const std::uint64_t hash = fnv1a(layout_fingerprint_v<L>, BLOCK_ROWS, 4);
+            return fnv1a(hash, host_is_little_endian() ? 1 : 0, 1);
+        }
+
+        constexpr size_t align_up(size_t value, size_t alignment) noexcept {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        /**
+         * @brief Describes where everything lives in a columnar file for layout L
+         *
+         */
+        template<typename L, size_t BLOCK_ROWS>
+        struct columnar_geometry {
+            static_assert(BLOCK_ROWS % 64 == 0 && BLOCK_ROWS > 0, "Columnar blocks must be a multiple of 64 rows");
+
+            static constexpr size_t fields = L::field_sizes.size();
+            static constexpr size_t header_bytes =
+                align_up(columnar_file_fixed_bytes + 2 * fields, columnar_file_align);
+
+            // The offset of each field within a block, in 64 bit words
+            static constexpr std::array<size_t, fields> field_words = [] {
+                std::array<size_t, fields> words {};
+                for(size_t f = 1; f < fields; ++f) {
+                    words[f] = words[f - 1] + BLOCK_ROWS * L::field_sizes[f - 1] / 64;
+                }
+                return words;
+            }();
+
+            static constexpr size_t block_words = [] {
+                size_t bits = 0;
+                for(const size_t width : L::field_sizes) { bits += width; }
+                return BLOCK_ROWS * bits / 64;
+            }();
+
+            size_t rows   = 0;
+            size_t blocks = 0;
+
+            constexpr size_t zone_offset() const noexcept { return header_bytes; }
+            constexpr size_t data_offset() const noexcept {
+                return align_up(header_bytes + blocks * fields * 2 * sizeof(std::uint64_t), columnar_file_align);
+            }
+            constexpr size_t column_offset(size_t block, size_t field) const noexcept {
+                return data_offset() + (block * block_words + field_words[field]) * sizeof(std::uint64_t);
+            }
+            constexpr size_t file_bytes() const noexcept { return data_offset() + blocks * block_words * sizeof(std::uint64_t); }
+
+            static constexpr size_t column_bytes(size_t field) noexcept {
+                return BLOCK_ROWS * L::field_sizes[field] / 64 * sizeof(std::uint64_t);
+            }
+        };
+
+        template<typename P, size_t BLOCK_ROWS, size_t... Is>
+        void write_columnar_block(const P* rows,
+                                  size_t count,
+                                  std::uint64_t* zones,
+                                  std::vector<std::uint64_t>& words,
+                                  std::index_sequence<Is...>) {
+            using layout_type = typename P::layout_type;
+            using geometry    = columnar_geometry<layout_type, BLOCK_ROWS>;
+            std::vector<std::uint64_t> column(BLOCK_ROWS);
+            words.assign(geometry::block_words, 0);
+            (
+                [&] {
+                    std::fill(column.begin(), column.end(), std::uint64_t(0));
+                    std::uint64_t lo = std::numeric_limits<std::uint64_t>::max();
+                    std::uint64_t hi = 0;
+                    for(size_t r = 0; r < count; ++r) {
+                        column[r] = static_cast<std::uint64_t>(rows[r].template get<Is>());
+                        lo        = std::min(lo, column[r]);
+                        hi        = std::max(hi, column[r]);
+                    }
+                    zones[2 * Is]     = lo;
+                    zones[2 * Is + 1] = hi;
+                    for_pack<layout_type::field_sizes[Is], BLOCK_ROWS>(
+                        column.data(), std::uint64_t(0), words.data() + geometry::field_words[Is]);
+                }(),
+                ...);
+        }
+    }
+
+    /**
+     * @brief Writes bitpacks to a columnar file with per block zone maps, readable with columnar_file
+     *
+     * @tparam BLOCK_ROWS The number of rows per block, a multiple of 64
+     * @param path The path of the file, which is replaced if it exists
+     * @param records A contiguous range of bitpacks
+     * @return packed_file_status OK on success
+     */
+    template<size_t BLOCK_ROWS = 4096, typename R>
+    packed_file_status write_columnar_file(const char* path, const R& records) {
+        using pack_type   = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(records))>>;
+        using layout_type = typename pack_type::layout_type;
+        using geometry    = detail::columnar_geometry<layout_type, BLOCK_ROWS>;
+
+        const pack_type* rows = std::data(records);
+        geometry layout_geometry;
+        layout_geometry.rows   = std::size(records);
+        layout_geometry.blocks = (layout_geometry.rows + BLOCK_ROWS - 1) / BLOCK_ROWS;
+
+        std::vector<std::uint8_t> header(std::begin(detail::columnar_file_magic), std::end(detail::columnar_file_magic));
+        detail::put_le(header, layout_geometry.rows, 8);
+        detail::put_le(header, BLOCK_ROWS, 4);
+        detail::put_le(header, geometry::fields, 2);
+        detail::put_le(header, 0, 2);
+        detail::put_le(header, detail::columnar_file_schema<layout_type, BLOCK_ROWS>(), 8);
+        for(const size_t width : layout_type::field_sizes) { detail::put_le(header, width, 2); }
+
+        std::FILE* file = std::fopen(path, "wb");
+        if(file == nullptr) {
+            return packed_file_status::OPEN_FAILED;
+        }
+
+        // Blocks are streamed out as they are packed, leaving room for the zone maps, which are only known once
+        // every block has been seen
+        std::vector<std::uint64_t> zones(layout_geometry.blocks * geometry::fields * 2);
+        header.resize(layout_geometry.data_offset(), 0);
+        bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+
+        std::vector<std::uint64_t> words;
+        std::vector<std::uint8_t> bytes;
+        for(size_t b = 0; ok && b < layout_geometry.blocks; ++b) {
+            const size_t first = b * BLOCK_ROWS;
+            detail::write_columnar_block<pack_type, BLOCK_ROWS>(rows + first,
+                                                                std::min(BLOCK_ROWS, layout_geometry.rows - first),
+                                                                zones.data() + b * geometry::fields * 2,
+                                                                words,
+                                                                std::make_index_sequence<geometry::fields>());
+            bytes.clear();
+            for(const std::uint64_t w : words) { detail::put_le(bytes, w, 8); }
+            ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        }
+
+        bytes.clear();
+        for(const std::uint64_t z : zones) { detail::put_le(bytes, z, 8); }
+        // An empty file has no zone maps, and fwrite doesn't accept the null data of an empty vector
+        if(!bytes.empty()) {
+            ok = ok && std::fseek(file, static_cast<long>(geometry::header_bytes), SEEK_SET) == 0;
+            ok = ok && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        }
+        ok = std::fclose(file) == 0 && ok;
+        return ok ? packed_file_status::OK : packed_file_status::WRITE_FAILED;
+    }
+
+    /**
+     * @brief Reader for columnar files written by write_columnar_file.
+     *
+     * Predicate scans check each block's zone map first, and blocks whose range of the scanned field cannot match are
+     * skipped without being read or decoded.
+     *
+     * @tparam L The layout of the rows
+     * @tparam BLOCK_ROWS The number of rows per block the file was written with
+     * @tparam D The storage detector
+     */
+    template<typename L, size_t BLOCK_ROWS = 4096, template<storage_preference, size_t> typename D = layout_storage_detector>
+    class columnar_file {
+        using geometry = detail::columnar_geometry<L, BLOCK_ROWS>;
+
+    public:
+        /**
+         * @brief The type of the rows
+         *
+         */
+        using value_type = bitpack<L, D>;
+
+        columnar_file() = default;
+
+        columnar_file(const columnar_file&)            = delete;
+        columnar_file& operator=(const columnar_file&) = delete;
+
+        ~columnar_file() { close(); }
+
+        /**
+         * @brief Opens a columnar file and checks its header against the layout
+         *
+         * @param path The path of the file
+         * @param access Whether to map the file or read column blocks on demand
+         * @return packed_file_status OK on success
+         */
+        packed_file_status open(const char* path, columnar_access access = columnar_access::MMAP) {
+            close();
+            _fd = ::open(path, O_RDONLY);
+            if(_fd < 0) {
+                return packed_file_status::OPEN_FAILED;
+            }
+            struct stat info {};
+            if(::fstat(_fd, &info) != 0) {
+                close();
+                return packed_file_status::OPEN_FAILED;
+            }
+            const auto length = static_cast<size_t>(info.st_size);
+
+            std::vector<std::uint8_t> header(geometry::header_bytes);
+            if(length < geometry::header_bytes || !_read_at(0, header.data(), header.size())) {
+                close();
+                return packed_file_status::BAD_HEADER;
+            }
+            if(std::memcmp(header.data(), detail::columnar_file_magic, sizeof(detail::columnar_file_magic)) != 0) {
+                close();
+                return packed_file_status::BAD_HEADER;
+            }
+            if(detail::get_le(header.data() + 24, 8) != detail::columnar_file_schema<L, BLOCK_ROWS>()) {
+                close();
+                return packed_file_status::SCHEMA_MISMATCH;
+            }
+
+            _geometry.rows   = static_cast<size_t>(detail::get_le(header.data() + 8, 8));
+            _geometry.blocks = (_geometry.rows + BLOCK_ROWS - 1) / BLOCK_ROWS;
+            if(length < _geometry.file_bytes()) {
+                close();
+                return packed_file_status::TRUNCATED;
+            }
+
+            _zones.resize(_geometry.blocks * geometry::fields * 2);
+            if(!_read_at(_geometry.zone_offset(), _zones.data(), _zones.size() * sizeof(std::uint64_t))) {
+                close();
+                return packed_file_status::TRUNCATED;
+            }
+
+            if(access == columnar_access::MMAP) {
+                void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, _fd, 0);
+                if(mapping == MAP_FAILED) {
+                    close();
+                    return packed_file_status::MAPPING_FAILED;
+                }
+                _mapping = static_cast<const std::uint8_t*>(mapping);
+                _length  = length;
+            }
+            return packed_file_status::OK;
+        }
+
+        void close() noexcept {
+            if(_mapping != nullptr) {
+                ::munmap(const_cast<std::uint8_t*>(_mapping), _length);
+            }
+            if(_fd >= 0) {
+                ::close(_fd);
+            }
+            _mapping  = nullptr;
+            _length   = 0;
+            _fd       = -1;
+            _geometry = geometry {};
+            _zones.clear();
+        }
+
+        bool is_open() const noexcept { return _fd >= 0; }
+        size_t size() const noexcept { return _geometry.rows; }
+        size_t block_count() const noexcept { return _geometry.blocks; }
+
+        /**
+         * @brief Gets the smallest value of field I in block b
+         *
+         */
+        template<auto I>
+        std::uint64_t block_min(size_t b) const noexcept {
+            return _zones[(b * geometry::fields + detail::index_to_sizet<I>()) * 2];
+        }
+
+        /**
+         * @brief Gets the largest value of field I in block b
+         *
+         */
+        template<auto I>
+        std::uint64_t block_max(size_t b) const noexcept {
+            return _zones[(b * geometry::fields + detail::index_to_sizet<I>()) * 2 + 1];
+        }
+
+        /**
+         * @brief Decodes field I of block b into out, which must have room for BLOCK_ROWS values
+         *
+         * @return bool false if the column block could not be read
+         */
+        template<auto I>
+        bool decode_block(size_t b, std::uint64_t* out) const {
+            constexpr size_t field = detail::index_to_sizet<I>();
+            std::vector<std::uint64_t> buffer;
+            const std::uint64_t* words = _column(b, field, buffer);
+            if(words == nullptr) {
+                return false;
+            }
+            detail::for_unpack<L::field_sizes[field], BLOCK_ROWS>(words, std::uint64_t(0), out);
+            return true;
+        }
+
+        /**
+         * @brief Calls fn(row_index, value) for every row whose field I lies within [lo, hi]. Blocks whose zone map
+         * does not overlap [lo, hi] are skipped without being read.
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param lo The smallest matching value
+         * @param hi The largest matching value
+         * @param fn The function called for each matching row
+         * @return scan_stats The number of blocks and column bytes scanned and skipped
+         */
+        template<auto I, typename F>
+        scan_stats scan(std::uint64_t lo, std::uint64_t hi, F&& fn) const {
+            constexpr size_t field = detail::index_to_sizet<I>();
+            scan_stats stats;
+            std::vector<std::uint64_t> values(BLOCK_ROWS);
+            for(size_t b = 0; b < _geometry.blocks; ++b) {
+                if(block_max<I>(b) < lo || block_min<I>(b) > hi) {
+                    ++stats.blocks_skipped;
+                    stats.bytes_skipped += geometry::column_bytes(field);
+                    continue;
+                }
+                ++stats.blocks_scanned;
+                stats.bytes_scanned += geometry::column_bytes(field);
+                if(!decode_block<I>(b, values.data())) {
+                    break;
+                }
+                const size_t first = b * BLOCK_ROWS;
+                const size_t count = std::min(BLOCK_ROWS, _geometry.rows - first);
+                for(size_t r = 0; r < count; ++r) {
+                    if(values[r] >= lo && values[r] <= hi) {
+                        fn(first + r, values[r]);
+                    }
+                }
+            }
+            return stats;
+        }
+
+        /**
+         * @brief Reassembles a whole row from its columns
+         *
+         * @param idx The index of the row
+         * @return value_type The row
+         */
+        value_type row(size_t idx) const {
+            assert(idx < _geometry.rows && "columnar_file row out of range");
+            return _row(idx, std::make_index_sequence<geometry::fields>());
+        }
+
+    private:
+        int _fd                      = -1;
+        const std::uint8_t* _mapping = nullptr;
+        size_t _length               = 0;
+        geometry _geometry;
+        std::vector<std::uint64_t> _zones;
+
+        bool _read_at(size_t offset, void* out, size_t bytes) const noexcept {
+            auto* dst = static_cast<std::uint8_t*>(out);
+            while(bytes > 0) {
+                const ssize_t got = ::pread(_fd, dst, bytes, static_cast<off_t>(offset));
+                if(got <= 0) {
+                    return false;
+                }
+                dst += got;
+                offset += static_cast<size_t>(got);
+                bytes -= static_cast<size_t>(got);
+            }
+            return true;
+        }
+
+        // Returns the words of a column block, either in place in the mapping or read into buffer
+        const std::uint64_t* _column(size_t block, size_t field, std::vector<std::uint64_t>& buffer) const {
+            const size_t offset = _geometry.column_offset(block, field);
+            if(_mapping != nullptr) {
+                return reinterpret_cast<const std::uint64_t*>(_mapping + offset);
+            }
+            buffer.resize(geometry::column_bytes(field) / sizeof(std::uint64_t));
+            return _read_at(offset, buffer.data(), geometry::column_bytes(field)) ? buffer.data() : nullptr;
+        }
+
+        // Reads one value of a column block, touching at most two words of it
+        std::uint64_t _value_at(size_t block, size_t field, size_t r) const noexcept {
+            const size_t width = L::field_sizes[field];
+            if(_mapping != nullptr) {
+                const auto* words = reinterpret_cast<const std::uint64_t*>(_mapping + _geometry.column_offset(block, field));
+                return detail::read_packed(words, width, r);
+            }
+            if(width == 0) {
+                return 0;
+            }
+            const size_t word        = r * width / 64;
+            const size_t offset      = r * width % 64;
+            std::uint64_t words[2]   = { 0, 0 };
+            const size_t word_count  = offset + width > 64 ? 2 : 1;
+            const size_t byte_offset = _geometry.column_offset(block, field) + word * sizeof(std::uint64_t);
+            if(!_read_at(byte_offset, words, word_count * sizeof(std::uint64_t))) {
+                return 0;
+            }
+            const std::uint64_t value = (words[0] >> offset) | (word_count == 2 ? words[1] << (64 - offset) : 0);
+            return value & detail::low_mask(width);
+        }
+
+        template<size_t... Is>
+        value_type _row(size_t idx, std::index_sequence<Is...>) const {
+            using storage_type = typename value_type::storage_type;
+            const size_t block = idx / BLOCK_ROWS;
+            const size_t r     = idx % BLOCK_ROWS;
+            storage_type data  = 0;
+            ((data |= static_cast<storage_type>(static_cast<storage_type>(_value_at(block, Is, r)) << L::field_offsets[Is])),
+             ...);
+            return value_type(data);
+        }
+    };
+}
+
+#endif
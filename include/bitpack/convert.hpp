@@ -0,0 +1,208 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_CONVERT_HPP
+#define BITPACK_CONVERT_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace bitpack {
+    namespace detail {
+        // Index used for a field of the new layout with no matching field in the old one
+        constexpr size_t no_source = static_cast<size_t>(-1);
+
+        template<typename L, typename TAG, size_t... Is>
+        constexpr size_t tag_count(std::index_sequence<Is...>) noexcept {
+            return (size_t(std::is_same_v<layout_field_tag_t<L, Is>, TAG>) + ... + 0);
+        }
+
+        template<typename L, size_t... Is>
+        constexpr bool distinct_field_tags(std::index_sequence<Is...> fields) noexcept {
+            return ((std::is_void_v<layout_field_tag_t<L, Is>> || tag_count<L, layout_field_tag_t<L, Is>>(fields) == 1) && ... &&
+                    true);
+        }
+
+        template<typename L, typename TAG, size_t... Is>
+        constexpr size_t tag_index(std::index_sequence<Is...>) noexcept {
+            size_t index = no_source;
+            ((index = std::is_same_v<layout_field_tag_t<L, Is>, TAG> ? Is : index), ...);
+            return index;
+        }
+
+        /**
+         * @brief Finds the field of LO that field J of LN is copied from. Tagged fields match the field of LO with the
+         * same tag, wherever it is. Untagged fields match the untagged field of LO at the same index.
+         *
+         * @return constexpr size_t The index of the field in LO, or no_source if J starts out as zero
+         */
+        template<typename LO, typename LN, size_t J>
+        constexpr size_t convert_source() noexcept {
+            using tag = layout_field_tag_t<LN, J>;
+            if constexpr(!std::is_void_v<tag>) {
+                return tag_index<LO, tag>(std::make_index_sequence<LO::field_sizes.size()>());
+            }
+            else if constexpr(J < LO::field_sizes.size()) {
+                return std::is_void_v<layout_field_tag_t<LO, J>> ? J : no_source;
+            }
+            else {
+                return no_source;
+            }
+        }
+
+        template<typename LO, typename LN, size_t... Js>
+        constexpr std::array<size_t, sizeof...(Js)> convert_sources(std::index_sequence<Js...>) noexcept {
+            return { convert_source<LO, LN, Js>()... };
+        }
+
+        /**
+         * @brief How to move the bits of a bitpack of one layout into another. Fields that move by the same distance
+         * (such as a run of fields that keep their relative offsets) share a group, and each group is one mask and one
+         * shift of the whole storage word.
+         *
+         * @tparam N The number of fields in the new layout, which bounds the number of groups
+         */
+        template<size_t N>
+        struct convert_plan {
+            size_t group_count = 0;
+            // The distance each group moves, as the new offset minus the old offset
+            std::array<int, N> shifts {};
+            // The bits of the old storage moved by each group
+            std::array<std::uint64_t, N> masks {};
+            // The bits of the old storage that don't fit their field in the new layout
+            std::uint64_t lost = 0;
+        };
+
+        template<typename LO, typename LN>
+        constexpr auto make_convert_plan() noexcept {
+            constexpr size_t fields = LN::field_sizes.size();
+            constexpr auto sources  = convert_sources<LO, LN>(std::make_index_sequence<fields>());
+            convert_plan<fields> plan {};
+            for(size_t j = 0; j < fields; ++j) {
+                if(sources[j] == no_source) {
+                    continue;
+                }
+                const size_t old_width  = LO::field_sizes[sources[j]];
+                const size_t old_offset = LO::field_offsets[sources[j]];
+                const size_t width      = std::min(old_width, LN::field_sizes[j]);
+                const int shift         = static_cast<int>(LN::field_offsets[j]) - static_cast<int>(old_offset);
+                plan.lost |= (low_mask(old_width) & ~low_mask(width)) << old_offset;
+
+                size_t group = 0;
+                while(group < plan.group_count && plan.shifts[group] != shift) { ++group; }
+                if(group == plan.group_count) {
+                    plan.shifts[plan.group_count++] = shift;
+                }
+                plan.masks[group] |= low_mask(width) << old_offset;
+            }
+            return plan;
+        }
+
+        template<typename LO, typename LN>
+        inline constexpr auto convert_plan_v = make_convert_plan<LO, LN>();
+
+        template<int SHIFT>
+        constexpr std::uint64_t shift_bits(std::uint64_t bits) noexcept {
+            if constexpr(SHIFT >= 0) {
+                return bits << SHIFT;
+            }
+            else {
+                return bits >> -SHIFT;
+            }
+        }
+
+        template<typename LO, typename LN, size_t... Gs>
+        constexpr std::uint64_t convert_bits(std::uint64_t bits, std::index_sequence<Gs...>) noexcept {
+            return (std::uint64_t(0) | ... |
+                    shift_bits<convert_plan_v<LO, LN>.shifts[Gs]>(bits & convert_plan_v<LO, LN>.masks[Gs]));
+        }
+
+        template<typename LO, typename LN>
+        constexpr void check_convertible() noexcept {
+            static_assert(distinct_field_tags<LO>(std::make_index_sequence<LO::field_sizes.size()>()),
+                          "Field tags of the old layout must be distinct");
+            static_assert(distinct_field_tags<LN>(std::make_index_sequence<LN::field_sizes.size()>()),
+                          "Field tags of the new layout must be distinct");
+        }
+    }
+
+    /**
+     * @brief Converts a bitpack to another layout. Each field of the new layout takes the value of the field of the old
+     * layout with the same tag, or of the untagged field with the same index, and is zero if there is neither. Fields that
+     * move by the same distance are moved together with one mask and shift. Values too wide for a narrowed field are
+     * truncated, after a debug assert under the ASSERT overflow policy.
+     *
+     * @tparam LN The new layout
+     * @param pack The bitpack to convert
+     * @return constexpr bitpack<LN, D, O> The converted bitpack, with the same detector and overflow policy
+     */
+    template<typename LN, typename LO, template<storage_preference, size_t> typename D, overflow_policy O>
+    constexpr bitpack<LN, D, O> convert(const bitpack<LO, D, O>& pack) noexcept {
+        detail::check_convertible<LO, LN>();
+        using new_storage = typename bitpack<LN, D, O>::storage_type;
+        constexpr auto& plan = detail::convert_plan_v<LO, LN>;
+
+        const std::uint64_t bits = pack.data();
+        if constexpr(O == overflow_policy::ASSERT) {
+            // Debug check to make sure that no field is narrowed below its value
+            assert((bits & plan.lost) == 0 && "A field value overflows its bitwidth in the new layout");
+        }
+        return bitpack<LN, D, O>(
+            static_cast<new_storage>(detail::convert_bits<LO, LN>(bits, std::make_index_sequence<plan.group_count>())));
+    }
+
+    /**
+     * @brief Converts n bitpacks to another layout as by convert(pack). The loop body is a handful of masks and shifts
+     * with no per-field work, so the compiler can vectorize it.
+     *
+     * @tparam LN The new layout
+     * @param in The bitpacks to convert
+     * @param n The number of bitpacks
+     * @param out The converted bitpacks, which must have room for n
+     * @return bool false if some value didn't fit its new width and was truncated
+     */
+    template<typename LN, typename LO, template<storage_preference, size_t> typename D, overflow_policy O>
+    bool convert(const bitpack<LO, D, O>* in, size_t n, bitpack<LN, D, O>* out) noexcept {
+        detail::check_convertible<LO, LN>();
+        using new_storage = typename bitpack<LN, D, O>::storage_type;
+        constexpr auto& plan = detail::convert_plan_v<LO, LN>;
+
+        std::uint64_t lost = 0;
+        for(size_t i = 0; i < n; ++i) {
+            const std::uint64_t bits = in[i].data();
+            lost |= bits & plan.lost;
+            out[i] = bitpack<LN, D, O>(
+                static_cast<new_storage>(detail::convert_bits<LO, LN>(bits, std::make_index_sequence<plan.group_count>())));
+        }
+        return lost == 0;
+    }
+}
+
+#endif
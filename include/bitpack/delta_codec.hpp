@@ -0,0 +1,336 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_DELTA_CODEC_HPP
+#define BITPACK_DELTA_CODEC_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/bulk.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <bitpack/for_codec.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief Marker type used to choose between delta and delta of delta encoding
+     *
+     * DELTA stores the difference between consecutive values, which suits values that rise slowly such as sequence numbers.
+     * DELTA_OF_DELTA stores the change in that difference, which suits values that rise at a near constant rate such as
+     * timestamps.
+     */
+    enum class delta_order {
+        DELTA,
+        DELTA_OF_DELTA
+    };
+
+    namespace detail {
+        /**
+         * @brief Replaces values[i] with initial + values[0] + ... + values[i]
+         *
+         */
+        template<typename T>
+        void prefix_sum(T* values, size_t n, T initial) noexcept {
+            size_t i = 0;
+#if defined(BITPACK_HAS_SSE2)
+            // Sums within a register with shifted adds, then carries the last lane into the next register
+            if constexpr(std::is_same_v<T, std::uint32_t>) {
+                __m128i carry = _mm_set1_epi32(static_cast<int>(initial));
+                for(; i + 4 <= n; i += 4) {
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+                    x         = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+                    x         = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+                    x         = _mm_add_epi32(x, carry);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+                    carry = _mm_shuffle_epi32(x, 0xFF);
+                }
+                initial = static_cast<T>(_mm_cvtsi128_si32(carry));
+            }
+            else if constexpr(std::is_same_v<T, std::uint64_t>) {
+                __m128i carry = _mm_set1_epi64x(static_cast<long long>(initial));
+                for(; i + 2 <= n; i += 2) {
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+                    x         = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+                    x         = _mm_add_epi64(x, carry);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+                    carry = _mm_shuffle_epi32(x, 0xEE);
+                }
+                initial = static_cast<T>(_mm_cvtsi128_si64(carry));
+            }
+#endif
+            for(; i < n; ++i) {
+                initial   = static_cast<T>(initial + values[i]);
+                values[i] = initial;
+            }
+        }
+
+        /**
+         * @brief Maps a two's complement difference to an unsigned value so that small magnitudes stay small
+         *
+         */
+        template<typename T>
+        constexpr T zigzag_encode(T value) noexcept {
+            const auto sign = static_cast<T>(T(0) - (value >> (std::numeric_limits<T>::digits - 1)));
+            return static_cast<T>(static_cast<T>(value << 1) ^ sign);
+        }
+
+        /**
+         * @brief Reverses zigzag_encode
+         *
+         */
+        template<typename T>
+        constexpr T zigzag_decode(T value) noexcept {
+            return static_cast<T>((value >> 1) ^ static_cast<T>(T(0) - (value & T(1))));
+        }
+    }
+
+    /**
+     * @brief A column of unsigned integers stored as deltas (or deltas of deltas) and then frame of reference bit packed.
+     *
+     * Each block stores its first value (and first delta) in its header, so any block can be decoded on its own. Decoding
+     * unpacks the block and rebuilds the values with a vectorized prefix sum. Differences are taken modulo 2^N, so values
+     * that are not monotonic still round trip, just at a wider width.
+     *
+     * @tparam T The unsigned integer type of the values
+     * @tparam O Whether to store deltas or deltas of deltas
+     * @tparam BLOCK_SIZE The number of values per block, either 128 or 256
+     */
+    template<typename T = std::uint64_t, delta_order O = delta_order::DELTA, size_t BLOCK_SIZE = 128>
+    class delta_column {
+        static_assert(std::is_unsigned_v<T>, "delta_column values must be unsigned integers");
+        static_assert(BLOCK_SIZE == 128 || BLOCK_SIZE == 256, "delta_column blocks must be 128 or 256 values");
+
+        static constexpr size_t max_width = std::numeric_limits<T>::digits;
+
+        // The number of leading values in a block that are stored in its header rather than packed
+        static constexpr size_t header_values = O == delta_order::DELTA ? 1 : 2;
+
+    public:
+        /**
+         * @brief The type of the values
+         *
+         */
+        using value_type = T;
+
+        /**
+         * @brief The number of values per block
+         *
+         */
+        static constexpr size_t block_size = BLOCK_SIZE;
+
+        /**
+         * @brief Constructs an empty column
+         *
+         */
+        delta_column() = default;
+
+        /**
+         * @brief Constructs a column by encoding n values
+         *
+         * @param values The values
+         * @param n The number of values
+         */
+        delta_column(const T* values, size_t n) : _size(n) {
+            static constexpr auto packers = detail::for_packers<BLOCK_SIZE, T>(std::make_index_sequence<max_width + 1>());
+
+            _blocks.reserve(block_count());
+            std::array<T, BLOCK_SIZE> residuals {};
+            for(size_t first = 0; first < n; first += BLOCK_SIZE) {
+                const size_t count = std::min(BLOCK_SIZE, n - first);
+                const T* src       = values + first;
+
+                block header {};
+                header.first       = src[0];
+                header.first_delta = count > 1 ? static_cast<T>(src[1] - src[0]) : T(0);
+                for(size_t i = 1; i < count; ++i) {
+                    const auto delta = static_cast<T>(src[i] - src[i - 1]);
+                    if constexpr(O == delta_order::DELTA) {
+                        residuals[i] = delta;
+                    }
+                    else if(i >= 2) {
+                        const auto previous = static_cast<T>(src[i - 1] - src[i - 2]);
+                        residuals[i]        = detail::zigzag_encode(static_cast<T>(delta - previous));
+                    }
+                }
+
+                // Values held in the header and padding past the end are filled with a packed value so they don't widen
+                // the block
+                const T filler = count > header_values ? residuals[header_values] : T(0);
+                std::fill(residuals.begin(), residuals.begin() + header_values, filler);
+                std::fill(residuals.begin() + count, residuals.end(), filler);
+
+                const auto [lo, hi] = std::minmax_element(residuals.begin(), residuals.end());
+                header.base         = *lo;
+                header.offset       = _words.size();
+                header.width        = static_cast<std::uint8_t>(detail::bit_width(*hi - *lo));
+
+                _words.resize(_words.size() + BLOCK_SIZE * header.width / 64);
+                packers[header.width](residuals.data(), header.base, _words.data() + header.offset);
+                _blocks.push_back(header);
+            }
+        }
+
+        /**
+         * @brief Constructs a column by encoding a contiguous range of values
+         *
+         * @param values The values
+         */
+        template<typename R, typename = std::enable_if_t<!std::is_pointer_v<std::decay_t<R>>>>
+        explicit delta_column(const R& values) : delta_column(std::data(values), std::size(values)) { }
+
+        /**
+         * @brief Constructs a column by encoding field I of a contiguous range of bitpacks
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param records The bitpacks
+         * @return delta_column The encoded field
+         */
+        template<auto I, typename R>
+        static delta_column from_field(const R& records) {
+            std::vector<T> values(std::size(records));
+            unpack_column<I>(records, values);
+            return delta_column(values);
+        }
+
+        /**
+         * @brief Decodes the column into field I of a contiguous range of bitpacks, which must have room for size() values
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param records The bitpacks
+         */
+        template<auto I, typename R>
+        void decode_field(R&& records) const {
+            assert(std::size(records) >= _size && "The bitpack range is shorter than the column");
+            std::vector<T> values(_size);
+            decode(values.data());
+            auto* out = std::data(records);
+            for(size_t i = 0; i < _size; ++i) {
+                out[i].template set<I>(values[i]);
+            }
+        }
+
+        /**
+         * @brief Gets the number of values in the column
+         *
+         */
+        size_t size() const noexcept { return _size; }
+
+        /**
+         * @brief Gets the number of blocks in the column
+         *
+         */
+        size_t block_count() const noexcept { return (_size + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+        /**
+         * @brief Gets the width in bits that the residuals of block b are packed at
+         *
+         */
+        size_t block_width(size_t b) const noexcept { return _blocks[b].width; }
+
+        /**
+         * @brief Gets the number of bytes used by the encoded column, including block headers
+         *
+         */
+        size_t size_in_bytes() const noexcept {
+            return _words.size() * sizeof(std::uint64_t) + _blocks.size() * sizeof(block);
+        }
+
+        /**
+         * @brief Decodes the block holding value i and returns the value
+         *
+         * @param i The index of the value
+         * @return T The value
+         */
+        T operator[](size_t i) const noexcept {
+            assert(i < _size && "delta_column index out of range");
+            std::array<T, BLOCK_SIZE> values;
+            decode_block(i / BLOCK_SIZE, values.data());
+            return values[i % BLOCK_SIZE];
+        }
+
+        /**
+         * @brief Decodes block b into out, which must have room for block_size values. Entries past the end of the
+         * column are unspecified.
+         *
+         * @param b The index of the block
+         * @param out The decoded values
+         */
+        void decode_block(size_t b, T* out) const noexcept {
+            static constexpr auto unpackers = detail::for_unpackers<BLOCK_SIZE, T>(std::make_index_sequence<max_width + 1>());
+            const block& header = _blocks[b];
+            unpackers[header.width](_words.data() + header.offset, header.base, out);
+
+            if constexpr(O == delta_order::DELTA_OF_DELTA) {
+                for(size_t i = 2; i < BLOCK_SIZE; ++i) { out[i] = detail::zigzag_decode(out[i]); }
+                detail::prefix_sum(out + 2, BLOCK_SIZE - 2, header.first_delta);
+                out[1] = header.first_delta;
+            }
+            out[0] = header.first;
+            detail::prefix_sum(out + 1, BLOCK_SIZE - 1, header.first);
+        }
+
+        /**
+         * @brief Decodes the whole column into out, which must have room for size() values
+         *
+         * @param out The decoded values
+         */
+        void decode(T* out) const noexcept {
+            const size_t full = _size / BLOCK_SIZE;
+            for(size_t b = 0; b < full; ++b) {
+                decode_block(b, out + b * BLOCK_SIZE);
+            }
+            if(full != block_count()) {
+                std::array<T, BLOCK_SIZE> tail;
+                decode_block(full, tail.data());
+                std::copy(tail.begin(), tail.begin() + (_size - full * BLOCK_SIZE), out + full * BLOCK_SIZE);
+            }
+        }
+
+    private:
+        /**
+         * @brief The header of a block
+         *
+         */
+        struct block {
+            T first;
+            T first_delta;
+            T base;
+            size_t offset;
+            std::uint8_t width;
+        };
+
+        std::vector<std::uint64_t> _words;
+        std::vector<block> _blocks;
+        size_t _size = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_DETAIL_BITS_HPP
+#define BITPACK_DETAIL_BITS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    include <emmintrin.h>
+#    define BITPACK_HAS_SSE2 1
+#endif
+
+#if defined(__BMI2__)
+#    include <immintrin.h>
+#endif
+
+namespace bitpack {
+    namespace detail {
+        /**
+         * @brief Counts the number of set bits in x
+         *
+         */
+        constexpr size_t popcount(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<size_t>(__builtin_popcountll(x));
+#else
+            x = x - ((x >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return static_cast<size_t>((x * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+
+        /**
+         * @brief Counts the number of zero bits below the lowest set bit of x. Returns 64 when x is 0.
+         *
+         */
+        constexpr size_t countr_zero(std::uint64_t x) noexcept {
+            if(x == 0) {
+                return 64;
+            }
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<size_t>(__builtin_ctzll(x));
+#else
+            size_t n = 0;
+            for(; (x & 1) == 0; x >>= 1) { ++n; }
+            return n;
+#endif
+        }
+
+        /**
+         * @brief Gets the number of bits needed to represent x. Returns 0 when x is 0.
+         *
+         */
+        constexpr size_t bit_width(std::uint64_t x) noexcept {
+            if(x == 0) {
+                return 0;
+            }
+#if defined(__GNUC__) || defined(__clang__)
+            return 64 - static_cast<size_t>(__builtin_clzll(x));
+#else
+            size_t n = 0;
+            for(; x != 0; x >>= 1) { ++n; }
+            return n;
+#endif
+        }
+
+        /**
+         * @brief Gets a mask of the lowest w bits, where w may be anything from 0 to 64
+         *
+         */
+        constexpr std::uint64_t low_mask(size_t w) noexcept {
+            // Split into two shifts so w = 64 doesn't need a branch
+            return ((std::uint64_t(1) << (w / 2)) << (w - w / 2)) - 1;
+        }
+
+        /**
+         * @brief Gets the position of the set bit of x with k set bits below it. x must have more than k set bits.
+         *
+         */
+        inline size_t select_in_word(std::uint64_t x, size_t k) noexcept {
+#if defined(__BMI2__)
+            return countr_zero(_pdep_u64(std::uint64_t(1) << k, x));
+#else
+            // Find the byte holding the bit from the running byte counts, then clear the lower set bits of that byte
+            std::uint64_t counts = x - ((x >> 1) & 0x5555555555555555ULL);
+            counts               = (counts & 0x3333333333333333ULL) + ((counts >> 2) & 0x3333333333333333ULL);
+            counts               = ((counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0FULL) * 0x0101010101010101ULL;
+            size_t byte          = 0;
+            while(((counts >> (byte * 8)) & 0xFF) <= k) { ++byte; }
+            size_t below = byte == 0 ? 0 : static_cast<size_t>((counts >> (byte * 8 - 8)) & 0xFF);
+            std::uint64_t bits = (x >> (byte * 8)) & 0xFF;
+            for(; below < k; ++below) { bits &= bits - 1; }
+            return byte * 8 + countr_zero(bits);
+#endif
+        }
+
+        /**
+         * @brief Reverses the byte order of x
+         *
+         */
+        constexpr std::uint64_t byteswap(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_bswap64(x);
+#else
+            std::uint64_t r = 0;
+            for(size_t i = 0; i < 8; ++i, x >>= 8) { r = (r << 8) | (x & 0xFF); }
+            return r;
+#endif
+        }
+
+        /**
+         * @brief Loads 8 little endian bytes from an unaligned address
+         *
+         */
+        inline std::uint64_t load_le64(const void* src) noexcept {
+            std::uint64_t x;
+            std::memcpy(&x, src, sizeof(x));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            x = byteswap(x);
+#endif
+            return x;
+        }
+
+        /**
+         * @brief Stores x as 8 little endian bytes to an unaligned address
+         *
+         */
+        inline void store_le64(void* dst, std::uint64_t x) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            x = byteswap(x);
+#endif
+            std::memcpy(dst, &x, sizeof(x));
+        }
+    }
+}
+
+#endif
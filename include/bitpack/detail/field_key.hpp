@@ -0,0 +1,89 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_DETAIL_FIELD_KEY_HPP
+#define BITPACK_DETAIL_FIELD_KEY_HPP
+
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace bitpack {
+    namespace detail {
+        /**
+         * @brief Builds an integer key from a subset of a bitpack's fields. The first field is the most significant part of
+         * the key, so keys order like the field tuple.
+         *
+         * @tparam P The bitpack type
+         * @tparam FIELDS The indices of the fields that make up the key
+         */
+        template<typename P, auto... FIELDS>
+        struct field_key {
+            static_assert(sizeof...(FIELDS) > 0, "A field key requires at least one field");
+
+            using layout_type = typename P::layout_type;
+
+            /**
+             * @brief The width of each key field, in key order
+             *
+             */
+            static constexpr std::array<size_t, sizeof...(FIELDS)> widths = {
+                layout_type::field_sizes[index_to_sizet<FIELDS>()]...
+            };
+
+            /**
+             * @brief The offset of each key field within the key
+             *
+             */
+            static constexpr std::array<size_t, sizeof...(FIELDS)> shifts = field_offsets(widths, field_order::MSB_FIRST);
+
+            /**
+             * @brief The total number of bits in the key
+             *
+             */
+            static constexpr size_t total_bits = accumulate(widths.begin(), widths.end(), size_t(0));
+
+            static_assert(total_bits <= 64, "Field keys must fit in 64 bits");
+
+            /**
+             * @brief Builds the key of a bitpack
+             *
+             * @param pack The bitpack
+             * @return std::uint64_t The key
+             */
+            static std::uint64_t of(const P& pack) noexcept {
+                const std::array<std::uint64_t, sizeof...(FIELDS)> values = {
+                    static_cast<std::uint64_t>(pack.template get<FIELDS>())...
+                };
+                std::uint64_t key = 0;
+                for(size_t i = 0; i < values.size(); ++i) {
+                    key |= shifts[i] < 64 ? values[i] << shifts[i] : 0;
+                }
+                return key;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,102 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_DETAIL_THREADS_HPP
+#define BITPACK_DETAIL_THREADS_HPP
+
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    namespace detail {
+        // Inputs smaller than this per thread are not worth splitting across threads
+        constexpr size_t min_thread_chunk = size_t(1) << 16;
+
+        /**
+         * @brief Resolves a requested thread count for n items, where 0 means one thread per hardware thread. The result is
+         * capped so that every thread gets at least min_thread_chunk items.
+         *
+         * @param requested The requested number of threads
+         * @param n The number of items being processed
+         * @return size_t The number of threads to use (at least 1)
+         */
+        inline size_t resolve_thread_count(size_t requested, size_t n) noexcept {
+            if(requested == 0) {
+                requested = std::thread::hardware_concurrency();
+            }
+            const size_t cap = n / min_thread_chunk;
+            requested        = requested < cap ? requested : cap;
+            return requested == 0 ? 1 : requested;
+        }
+
+        /**
+         * @brief Runs fn(thread_index) on count threads and waits for all of them to finish. The calling thread runs index 0.
+         * If fn throws on the calling thread, or a thread fails to start, the started threads are still joined before the
+         * exception leaves.
+         *
+         * @param count The number of threads
+         * @param fn The function to run
+         */
+        template<typename F>
+        void run_on_threads(size_t count, F&& fn) {
+            struct join_guard {
+                std::vector<std::thread>& threads;
+                ~join_guard() {
+                    for(auto& thread : threads) {
+                        if(thread.joinable()) {
+                            thread.join();
+                        }
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            join_guard guard { workers };
+            workers.reserve(count > 0 ? count - 1 : 0);
+            for(size_t t = 1; t < count; ++t) {
+                workers.emplace_back([&fn, t]() { fn(t); });
+            }
+            fn(size_t(0));
+        }
+
+        /**
+         * @brief Gets the half open range [first, last) of the chunk a thread is responsible for when n items are split
+         * evenly across count threads
+         *
+         * @param n The number of items
+         * @param count The number of threads
+         * @param t The thread index
+         * @return std::pair<size_t, size_t> The first and last item of the chunk
+         */
+        inline std::pair<size_t, size_t> thread_chunk(size_t n, size_t count, size_t t) noexcept {
+            const size_t base  = n / count;
+            const size_t extra = n % count;
+            const size_t first = t * base + (t < extra ? t : extra);
+            return { first, first + base + (t < extra ? 1 : 0) };
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,70 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_DETAIL_TYPE_NAME_HPP
+#define BITPACK_DETAIL_TYPE_NAME_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace bitpack {
+    namespace detail {
+        /**
+         * @brief Gets the name of T as the compiler spells it, at compile time
+         *
+         */
+        template<typename T>
+        constexpr std::string_view raw_type_name() noexcept {
+#if defined(__clang__) || defined(__GNUC__)
+            constexpr std::string_view signature = __PRETTY_FUNCTION__;
+            constexpr size_t start               = signature.find("T = ") + 4;
+            constexpr size_t end                 = signature.find_first_of(";]", start);
+            return signature.substr(start, end - start);
+#elif defined(_MSC_VER)
+            constexpr std::string_view signature = __FUNCSIG__;
+            constexpr size_t start               = signature.find("raw_type_name<") + 14;
+            constexpr size_t end                 = signature.rfind(">(void)");
+            return signature.substr(start, end - start);
+#else
+            return "unknown type";
+#endif
+        }
+
+        /**
+         * @brief Gets a readable name for T from the compiler's function signature
+         *
+         */
+        template<typename T>
+        std::string type_name() {
+            std::string name(raw_type_name<T>());
+            // Untagged fields spell out their default tag, which is noise in a report
+            for(size_t at = name.find(", void>"); at != std::string::npos; at = name.find(", void>", at)) {
+                name.erase(at, 6);
+            }
+            return name;
+        }
+    }
+}
+
+#endif
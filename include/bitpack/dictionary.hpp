@@ -0,0 +1,284 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_DICTIONARY_HPP
+#define BITPACK_DICTIONARY_HPP
+
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief Maps 32 bit IDs to dense codes 0, 1, 2, ... in order of first appearance, so that a bitpack field only needs
+     * code_width() bits to store an ID.
+     *
+     * Encoding looks IDs up in an open addressing hash table whose slots are grouped in fours, so one probe compares an
+     * ID against a whole group at once. Decoding is a single load from the table of IDs.
+     *
+     * This is a side table rather than a field type of its own: the layout declares an ordinary narrow bitwidth for the
+     * field, and encode_field/decode_field translate between IDs and that field, since bitpack fields hold plain
+     * integers and have nowhere to keep a shared table.
+     */
+    class dictionary {
+    public:
+        /**
+         * @brief Returned by find when an ID has no code
+         *
+         */
+        static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+        dictionary() = default;
+
+        /**
+         * @brief Gets the code of an ID, giving it the next code if it doesn't have one yet
+         *
+         * @param id The ID
+         * @return std::uint32_t The code
+         */
+        std::uint32_t encode(std::uint32_t id) {
+            size_t g = 0;
+            const std::uint32_t code = _probe(id, g);
+            return code != npos ? code : _insert(id, g);
+        }
+
+        /**
+         * @brief Encodes n IDs into codes, giving new IDs the next free codes
+         *
+         * @param ids The IDs
+         * @param n The number of IDs
+         * @param codes The output, which must have room for n codes
+         */
+        void encode(const std::uint32_t* ids, size_t n, std::uint32_t* codes) {
+            // Hashing a small batch up front lets the group loads of the batch overlap
+            constexpr size_t batch = 8;
+            for(size_t first = 0; first < n; first += batch) {
+                const size_t count = first + batch < n ? batch : n - first;
+                if(!_groups.empty()) {
+                    for(size_t i = 0; i < count; ++i) { _prefetch(_home(ids[first + i])); }
+                }
+                for(size_t i = 0; i < count; ++i) { codes[first + i] = encode(ids[first + i]); }
+            }
+        }
+
+        /**
+         * @brief Gets the code of an ID without adding it
+         *
+         * @param id The ID
+         * @return std::uint32_t The code, or npos if the ID has no code
+         */
+        std::uint32_t find(std::uint32_t id) const noexcept {
+            size_t g = 0;
+            return _probe(id, g);
+        }
+
+        /**
+         * @brief Gets the ID a code stands for
+         *
+         * @param code A code returned by encode
+         * @return std::uint32_t The ID
+         */
+        std::uint32_t decode(std::uint32_t code) const noexcept {
+            assert(code < _ids.size() && "Code is not in the dictionary");
+            return _ids[code];
+        }
+
+        std::uint32_t operator[](std::uint32_t code) const noexcept { return decode(code); }
+
+        /**
+         * @brief Decodes n codes into IDs
+         *
+         */
+        void decode(const std::uint32_t* codes, size_t n, std::uint32_t* ids) const noexcept {
+            const std::uint32_t* table = _ids.data();
+            for(size_t i = 0; i < n; ++i) {
+                assert(codes[i] < _ids.size() && "Code is not in the dictionary");
+                ids[i] = table[codes[i]];
+            }
+        }
+
+        /**
+         * @brief Encodes a range of IDs into field I of a contiguous range of bitpacks. If the codes don't fit in the
+         * field, nothing is written and the IDs added by this call are removed again.
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param records The bitpacks, which must be at least as many as the IDs
+         * @param ids A contiguous range of IDs
+         * @return bool false if the dictionary has outgrown the width of field I
+         */
+        template<auto I, typename R, typename IDS>
+        bool encode_field(R&& records, const IDS& ids) {
+            using pack_type = std::remove_reference_t<decltype(*std::data(records))>;
+            constexpr size_t width = pack_type::layout_type::field_sizes[detail::index_to_sizet<I>()];
+            assert(std::size(records) >= std::size(ids) && "The bitpack range is shorter than the IDs");
+            std::vector<std::uint32_t> codes(std::size(ids));
+            const size_t known = _ids.size();
+            encode(std::data(ids), codes.size(), codes.data());
+            if(code_width() > width) {
+                // Codes are handed out in order, so the new IDs are exactly the ones past the old size
+                _ids.resize(known);
+                _rehash(_groups.size());
+                return false;
+            }
+            auto* out = std::data(records);
+            for(size_t i = 0; i < codes.size(); ++i) { out[i].template set<I>(codes[i]); }
+            return true;
+        }
+
+        /**
+         * @brief Decodes field I of a contiguous range of bitpacks into IDs
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param records The bitpacks
+         * @param ids The output, which must have room for one ID per bitpack
+         */
+        template<auto I, typename R>
+        void decode_field(const R& records, std::uint32_t* ids) const noexcept {
+            const auto* in             = std::data(records);
+            const std::uint32_t* table = _ids.data();
+            for(size_t i = 0; i < std::size(records); ++i) {
+                const auto code = static_cast<std::uint32_t>(in[i].template get<I>());
+                assert(code < _ids.size() && "Code is not in the dictionary");
+                ids[i] = table[code];
+            }
+        }
+
+        /**
+         * @brief Gets the number of distinct IDs
+         *
+         */
+        size_t size() const noexcept { return _ids.size(); }
+
+        bool empty() const noexcept { return _ids.empty(); }
+
+        /**
+         * @brief Gets the number of bits needed to store any code handed out so far
+         *
+         */
+        size_t code_width() const noexcept { return _ids.size() <= 1 ? 0 : detail::bit_width(_ids.size() - 1); }
+
+        /**
+         * @brief Gets the IDs, indexed by code
+         *
+         */
+        const std::vector<std::uint32_t>& ids() const noexcept { return _ids; }
+
+        void clear() noexcept {
+            _groups.clear();
+            _fill.clear();
+            _ids.clear();
+        }
+
+    private:
+        static constexpr size_t group_slots = 4;
+
+        struct alignas(16) group {
+            std::uint32_t keys[group_slots];
+            std::uint32_t codes[group_slots];
+        };
+
+        std::vector<group> _groups;
+        // Slots in a group are filled in order, so the number of used slots is enough to tell them apart
+        std::vector<std::uint8_t> _fill;
+        std::vector<std::uint32_t> _ids;
+        unsigned _shift = 64;
+
+        size_t _home(std::uint32_t id) const noexcept {
+            return static_cast<size_t>((std::uint64_t(id) * 0x9E3779B97F4A7C15ull) >> _shift);
+        }
+
+        void _prefetch(size_t g) const noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(&_groups[g]);
+#endif
+        }
+
+        static unsigned _matches(const group& candidates, std::uint32_t id) noexcept {
+#if defined(BITPACK_HAS_SSE2)
+            const __m128i keys  = _mm_load_si128(reinterpret_cast<const __m128i*>(candidates.keys));
+            const __m128i equal = _mm_cmpeq_epi32(keys, _mm_set1_epi32(static_cast<int>(id)));
+            return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+#else
+            unsigned mask = 0;
+            for(size_t s = 0; s < group_slots; ++s) { mask |= unsigned(candidates.keys[s] == id) << s; }
+            return mask;
+#endif
+        }
+
+        // Finds the code of id, or returns npos and sets g to the first group with a free slot
+        std::uint32_t _probe(std::uint32_t id, size_t& g) const noexcept {
+            if(_groups.empty()) {
+                return npos;
+            }
+            const size_t mask = _groups.size() - 1;
+            for(g = _home(id);; g = (g + 1) & mask) {
+                const unsigned used  = _fill[g];
+                const unsigned found = _matches(_groups[g], id) & ((1u << used) - 1);
+                if(found != 0) {
+                    return _groups[g].codes[detail::countr_zero(found)];
+                }
+                if(used < group_slots) {
+                    return npos;
+                }
+            }
+        }
+
+        std::uint32_t _insert(std::uint32_t id, size_t g) {
+            assert(_ids.size() < npos && "Dictionary is full");
+            // Grow at 3/4 load so probe sequences stay short
+            if(_groups.empty() || (_ids.size() + 1) * 4 > _groups.size() * group_slots * 3) {
+                _rehash(_groups.empty() ? 16 : _groups.size() * 2);
+                _probe(id, g);
+            }
+            const auto code = static_cast<std::uint32_t>(_ids.size());
+            _ids.push_back(id);
+            _place(id, code, g);
+            return code;
+        }
+
+        void _place(std::uint32_t id, std::uint32_t code, size_t g) noexcept {
+            const std::uint8_t slot = _fill[g]++;
+            _groups[g].keys[slot]   = id;
+            _groups[g].codes[slot]  = code;
+        }
+
+        void _rehash(size_t group_count) {
+            _groups.assign(group_count, group {});
+            _fill.assign(group_count, 0);
+            _shift = static_cast<unsigned>(64 - detail::bit_width(group_count - 1));
+            for(std::uint32_t code = 0; code < _ids.size(); ++code) {
+                size_t g = 0;
+                _probe(_ids[code], g);
+                _place(_ids[code], code, g);
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,206 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_ELIAS_FANO_HPP
+#define BITPACK_ELIAS_FANO_HPP
+
+#include <bitpack/bitvector.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <bitpack/for_codec.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief An Elias-Fano encoded sequence of non-decreasing unsigned integers.
+     *
+     * Each value is split into its lowest low_width() bits, stored bit packed, and its remaining high bits, stored in
+     * unary in a packed_bitvector: value i sets bit (value >> low_width()) + i. With low_width() = log2(universe / n),
+     * that takes at most 2 + log2(universe / n) bits per value. access() finds the high bits with one select; next_geq()
+     * jumps to the right bucket with one select of a clear bit.
+     *
+     * @tparam T The unsigned integer type of the values
+     */
+    template<typename T = std::uint64_t>
+    class elias_fano {
+        static_assert(std::is_unsigned_v<T>, "elias_fano only supports unsigned integers");
+
+    public:
+        elias_fano() = default;
+
+        /**
+         * @brief Encodes n non-decreasing values
+         *
+         * @param values The values
+         * @param n The number of values
+         */
+        elias_fano(const T* values, size_t n) : _size(n) {
+            assert((n == 0 || std::uint64_t(values[n - 1]) < std::numeric_limits<std::uint64_t>::max()) &&
+                   "The largest value must leave room for the universe");
+            const std::uint64_t universe = n == 0 ? 0 : std::uint64_t(values[n - 1]) + 1;
+            _universe                    = universe;
+            _low_width                   = n == 0 || universe <= n ? 0 : detail::bit_width(universe / n) - 1;
+            _lows.assign((n * _low_width + 63) / 64, 0);
+            _highs = packed_bitvector(n + static_cast<size_t>(universe >> _low_width) + 1);
+            for(size_t i = 0; i < n; ++i) {
+                assert((i == 0 || values[i - 1] <= values[i]) && "Elias-Fano values must be non-decreasing");
+                detail::write_packed(_lows.data(), _low_width, i, values[i]);
+                _highs.set(static_cast<size_t>(std::uint64_t(values[i]) >> _low_width) + i);
+            }
+            _highs.build();
+        }
+
+        /**
+         * @brief Encodes a contiguous range of non-decreasing values
+         *
+         */
+        template<typename R, typename = std::enable_if_t<!std::is_same_v<std::decay_t<R>, elias_fano>>>
+        explicit elias_fano(const R& values) : elias_fano(std::data(values), std::size(values)) {}
+
+        /**
+         * @brief Gets the number of values
+         *
+         */
+        size_t size() const noexcept { return _size; }
+
+        bool empty() const noexcept { return _size == 0; }
+
+        /**
+         * @brief Gets one more than the largest value
+         *
+         */
+        std::uint64_t universe() const noexcept { return _universe; }
+
+        /**
+         * @brief Gets the number of low bits stored per value
+         *
+         */
+        size_t low_width() const noexcept { return _low_width; }
+
+        /**
+         * @brief Gets value i
+         *
+         */
+        T access(size_t i) const noexcept {
+            assert(i < _size && "Index out of range");
+            return _value(i, _highs.select1(i));
+        }
+
+        T operator[](size_t i) const noexcept { return access(i); }
+
+        /**
+         * @brief Finds the first value not less than x
+         *
+         * @param x The value to search for
+         * @return size_t The index of the value, or size() if every value is less than x
+         */
+        size_t next_geq(std::uint64_t x) const noexcept {
+            if(x >= _universe) {
+                return _size;
+            }
+            // Values with high part h start after the h-th clear bit, and every set bit before that is a smaller value
+            const size_t high = static_cast<size_t>(x >> _low_width);
+            const std::uint64_t* words = _highs.data();
+            size_t position            = high == 0 ? 0 : _highs.select0(high - 1) + 1;
+            size_t i                   = position - high;
+            std::uint64_t word         = words[position / 64] & ~detail::low_mask(position % 64);
+            for(size_t w = position / 64;; word = words[++w]) {
+                for(; word != 0; word &= word - 1, ++i) {
+                    position = w * 64 + detail::countr_zero(word);
+                    if(_value(i, position) >= x) {
+                        return i;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Decodes every value into out, which must have room for size() values
+         *
+         */
+        void decode(T* out) const {
+            // Low bits are unpacked 64 at a time by the width specialized frame of reference kernels, then the high bits
+            // are merged in a word of the unary bitvector at a time
+            static constexpr auto unpackers = detail::for_unpackers<64, std::uint64_t>(std::make_index_sequence<65>());
+            std::uint64_t lows[64];
+            for(size_t g = 0; g < _size / 64; ++g) {
+                unpackers[_low_width](_lows.data() + g * _low_width, 0, lows);
+                for(size_t i = 0; i < 64; ++i) { out[g * 64 + i] = static_cast<T>(lows[i]); }
+            }
+            for(size_t i = _size / 64 * 64; i < _size; ++i) {
+                out[i] = static_cast<T>(detail::read_packed(_lows.data(), _low_width, i));
+            }
+
+            const std::uint64_t* words = _highs.data();
+            size_t i                   = 0;
+            for(size_t w = 0; i < _size; ++w) {
+                for(std::uint64_t word = words[w]; word != 0; word &= word - 1, ++i) {
+                    const size_t position = w * 64 + detail::countr_zero(word);
+                    out[i] |= static_cast<T>(std::uint64_t(position - i) << _low_width);
+                }
+            }
+        }
+
+        /**
+         * @brief Calls fn(value) for every value in order
+         *
+         */
+        template<typename F>
+        void for_each(F&& fn) const {
+            const std::uint64_t* words = _highs.data();
+            size_t i                   = 0;
+            for(size_t w = 0; i < _size; ++w) {
+                for(std::uint64_t word = words[w]; word != 0; word &= word - 1, ++i) {
+                    fn(_value(i, w * 64 + detail::countr_zero(word)));
+                }
+            }
+        }
+
+        /**
+         * @brief Gets the number of bytes used by the low bits and the unary bitvector
+         *
+         */
+        size_t size_in_bytes() const noexcept { return _lows.size() * sizeof(std::uint64_t) + _highs.size_in_bytes(); }
+
+    private:
+        size_t _size            = 0;
+        std::uint64_t _universe = 0;
+        size_t _low_width       = 0;
+        std::vector<std::uint64_t> _lows;
+        packed_bitvector _highs;
+
+        // Value i, whose high bits are set at position in the unary bitvector
+        T _value(size_t i, size_t position) const noexcept {
+            const std::uint64_t high = std::uint64_t(position - i) << _low_width;
+            return static_cast<T>(high | detail::read_packed(_lows.data(), _low_width, i));
+        }
+    };
+}
+
+#endif
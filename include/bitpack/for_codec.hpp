@@ -0,0 +1,320 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_FOR_CODEC_HPP
+#define BITPACK_FOR_CODEC_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    namespace detail {
+        /*
+
+            Width specialized bit packing kernels. Values are packed back to back into a little endian stream of 64 bit
+            words. Every group of 64 values at width W fills exactly W words, so N values (N a multiple of 64) always
+            take N * W / 64 words and every shift in the kernels is a compile time constant.
+
+        */
+
+        template<size_t W, size_t N, typename T>
+        void for_pack(const T* in, T base, std::uint64_t* out) noexcept {
+            static_assert(N % 64 == 0, "Blocks must be a multiple of 64 values");
+            if constexpr(W > 0) {
+                constexpr std::uint64_t mask = bitmask_v<std::uint64_t, W>;
+                for(size_t g = 0; g < N / 64; ++g) {
+                    const T* src       = in + g * 64;
+                    std::uint64_t* dst = out + g * W;
+                    std::fill(dst, dst + W, std::uint64_t(0));
+                    for(size_t i = 0; i < 64; ++i) {
+                        const size_t word     = (i * W) / 64;
+                        const size_t offset   = (i * W) % 64;
+                        const std::uint64_t v = static_cast<std::uint64_t>(src[i] - base) & mask;
+                        dst[word] |= v << offset;
+                        // Widths that divide 64 never straddle a word
+                        if constexpr(64 % W != 0) {
+                            if(offset + W > 64) {
+                                dst[word + 1] |= v >> (64 - offset);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        template<size_t W, size_t N, typename T>
+        void for_unpack(const std::uint64_t* in, T base, T* out) noexcept {
+            static_assert(N % 64 == 0, "Blocks must be a multiple of 64 values");
+            if constexpr(W == 0) {
+                std::fill(out, out + N, base);
+            }
+            else {
+                constexpr std::uint64_t mask = bitmask_v<std::uint64_t, W>;
+                for(size_t g = 0; g < N / 64; ++g) {
+                    const std::uint64_t* src = in + g * W;
+                    T* dst                   = out + g * 64;
+                    for(size_t i = 0; i < 64; ++i) {
+                        const size_t word   = (i * W) / 64;
+                        const size_t offset = (i * W) % 64;
+                        std::uint64_t v     = src[word] >> offset;
+                        if constexpr(64 % W != 0) {
+                            if(offset + W > 64) {
+                                v |= src[word + 1] << (64 - offset);
+                            }
+                        }
+                        dst[i] = static_cast<T>(base + static_cast<T>(v & mask));
+                    }
+                }
+            }
+        }
+
+        template<size_t N, typename T>
+        using for_pack_fn = void (*)(const T*, T, std::uint64_t*) noexcept;
+
+        template<size_t N, typename T>
+        using for_unpack_fn = void (*)(const std::uint64_t*, T, T*) noexcept;
+
+        // Jump tables from a runtime width to the kernel specialized for that width
+        template<size_t N, typename T, size_t... Ws>
+        constexpr std::array<for_pack_fn<N, T>, sizeof...(Ws)> for_packers(std::index_sequence<Ws...>) {
+            return { &for_pack<Ws, N, T>... };
+        }
+
+        template<size_t N, typename T, size_t... Ws>
+        constexpr std::array<for_unpack_fn<N, T>, sizeof...(Ws)> for_unpackers(std::index_sequence<Ws...>) {
+            return { &for_unpack<Ws, N, T>... };
+        }
+
+        /**
+         * @brief Writes v at index i of a stream of values packed at width w. The stream must be zeroed at that index and
+         * have room for it.
+         *
+         */
+        inline void write_packed(std::uint64_t* out, size_t w, size_t i, std::uint64_t v) noexcept {
+            if(w == 0) {
+                return;
+            }
+            const size_t word   = (i * w) / 64;
+            const size_t offset = (i * w) % 64;
+            v &= low_mask(w);
+            out[word] |= v << offset;
+            if(offset + w > 64) {
+                out[word + 1] |= v >> (64 - offset);
+            }
+        }
+
+        /**
+         * @brief Reads the value at index i of a stream of values packed at width w
+         *
+         */
+        inline std::uint64_t read_packed(const std::uint64_t* in, size_t w, size_t i) noexcept {
+            if(w == 0) {
+                return 0;
+            }
+            const size_t word   = (i * w) / 64;
+            const size_t offset = (i * w) % 64;
+            std::uint64_t v     = in[word] >> offset;
+            if(offset + w > 64) {
+                v |= in[word + 1] << (64 - offset);
+            }
+            return v & low_mask(w);
+        }
+    }
+
+    /**
+     * @brief A column of unsigned integers compressed with frame of reference bit packing.
+     *
+     * Values are split into blocks of BLOCK_SIZE. Each block stores its minimum as a base, and every value is packed as its
+     * distance from the base using the fewest bits that fit the largest distance in the block. Clustered values such as
+     * timestamps or IDs therefore take only a few bits each, regardless of their magnitude.
+     *
+     * @tparam T The unsigned integer type of the values
+     * @tparam BLOCK_SIZE The number of values per block, either 128 or 256
+     */
+    template<typename T = std::uint64_t, size_t BLOCK_SIZE = 128>
+    class for_column {
+        static_assert(std::is_unsigned_v<T>, "for_column values must be unsigned integers");
+        static_assert(BLOCK_SIZE == 128 || BLOCK_SIZE == 256, "for_column blocks must be 128 or 256 values");
+
+    public:
+        /**
+         * @brief The type of the values
+         *
+         */
+        using value_type = T;
+
+        /**
+         * @brief The number of values per block
+         *
+         */
+        static constexpr size_t block_size = BLOCK_SIZE;
+
+        /**
+         * @brief Constructs an empty column
+         *
+         */
+        for_column() = default;
+
+        /**
+         * @brief Constructs a column by encoding n values
+         *
+         * @param values The values
+         * @param n The number of values
+         */
+        for_column(const T* values, size_t n) : _size(n) {
+            static constexpr auto packers =
+                detail::for_packers<BLOCK_SIZE, T>(std::make_index_sequence<std::numeric_limits<T>::digits + 1>());
+
+            _blocks.reserve(block_count());
+            std::array<T, BLOCK_SIZE> padded {};
+            for(size_t first = 0; first < n; first += BLOCK_SIZE) {
+                const size_t count = std::min(BLOCK_SIZE, n - first);
+                const T* src       = values + first;
+                const auto [lo, hi] = std::minmax_element(src, src + count);
+                const block header { *lo, _words.size(), static_cast<std::uint8_t>(detail::bit_width(*hi - *lo)) };
+
+                // The last block is padded with its base so the kernels always see a full block
+                if(count < BLOCK_SIZE) {
+                    std::copy(src, src + count, padded.begin());
+                    std::fill(padded.begin() + count, padded.end(), header.base);
+                    src = padded.data();
+                }
+
+                _words.resize(_words.size() + BLOCK_SIZE * header.width / 64);
+                packers[header.width](src, header.base, _words.data() + header.offset);
+                _blocks.push_back(header);
+            }
+        }
+
+        /**
+         * @brief Constructs a column by encoding a contiguous range of values
+         *
+         * @param values The values
+         */
+        template<typename R, typename = std::enable_if_t<!std::is_pointer_v<std::decay_t<R>>>>
+        explicit for_column(const R& values) : for_column(std::data(values), std::size(values)) { }
+
+        /**
+         * @brief Gets the number of values in the column
+         *
+         */
+        size_t size() const noexcept { return _size; }
+
+        /**
+         * @brief Gets the number of blocks in the column
+         *
+         */
+        size_t block_count() const noexcept { return (_size + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+        /**
+         * @brief Gets the base (minimum) of block b
+         *
+         */
+        T block_base(size_t b) const noexcept { return _blocks[b].base; }
+
+        /**
+         * @brief Gets the width in bits that values in block b are packed at
+         *
+         */
+        size_t block_width(size_t b) const noexcept { return _blocks[b].width; }
+
+        /**
+         * @brief Gets the number of bytes used by the encoded column, including block headers
+         *
+         */
+        size_t size_in_bytes() const noexcept {
+            return _words.size() * sizeof(std::uint64_t) + _blocks.size() * sizeof(block);
+        }
+
+        /**
+         * @brief Decodes a single value without decoding its block
+         *
+         * @param i The index of the value
+         * @return T The value
+         */
+        T operator[](size_t i) const noexcept {
+            assert(i < _size && "for_column index out of range");
+            const block& header = _blocks[i / BLOCK_SIZE];
+            const std::uint64_t delta = detail::read_packed(_words.data() + header.offset, header.width, i % BLOCK_SIZE);
+            return static_cast<T>(header.base + delta);
+        }
+
+        /**
+         * @brief Decodes block b into out, which must have room for block_size values. Entries past the end of the
+         * column are set to the block's base.
+         *
+         * @param b The index of the block
+         * @param out The decoded values
+         */
+        void decode_block(size_t b, T* out) const noexcept {
+            static constexpr auto unpackers =
+                detail::for_unpackers<BLOCK_SIZE, T>(std::make_index_sequence<std::numeric_limits<T>::digits + 1>());
+            const block& header = _blocks[b];
+            unpackers[header.width](_words.data() + header.offset, header.base, out);
+        }
+
+        /**
+         * @brief Decodes the whole column into out, which must have room for size() values
+         *
+         * @param out The decoded values
+         */
+        void decode(T* out) const noexcept {
+            const size_t full = _size / BLOCK_SIZE;
+            for(size_t b = 0; b < full; ++b) {
+                decode_block(b, out + b * BLOCK_SIZE);
+            }
+            if(full != block_count()) {
+                std::array<T, BLOCK_SIZE> tail;
+                decode_block(full, tail.data());
+                std::copy(tail.begin(), tail.begin() + (_size - full * BLOCK_SIZE), out + full * BLOCK_SIZE);
+            }
+        }
+
+    private:
+        /**
+         * @brief The header of a block
+         *
+         */
+        struct block {
+            T base;
+            size_t offset;
+            std::uint8_t width;
+        };
+
+        std::vector<std::uint64_t> _words;
+        std::vector<block> _blocks;
+        size_t _size = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,213 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_GROUP_AGGREGATE_HPP
+#define BITPACK_GROUP_AGGREGATE_HPP
+
+#include <algorithm>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/field_key.hpp>
+#include <bitpack/detail/threads.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief Marker type used to pass the index of the aggregated field to group_aggregate
+     *
+     * @tparam I The index of the field
+     */
+    template<auto I>
+    struct value_field_t { };
+
+    /**
+     * @brief Helper variable for value_field_t<I>
+     *
+     * @tparam I The index of the field
+     */
+    template<auto I>
+    constexpr value_field_t<I> value_field {};
+
+    /**
+     * @brief Aggregator that sums the value field of each group
+     *
+     */
+    struct sum_aggregate {
+        using state_type = std::uint64_t;
+
+        constexpr state_type init() const noexcept { return 0; }
+        constexpr void add(state_type& state, std::uint64_t value) const noexcept { state += value; }
+        constexpr void merge(state_type& state, const state_type& other) const noexcept { state += other; }
+    };
+
+    /**
+     * @brief Aggregator that finds the smallest value field of each group
+     *
+     */
+    struct min_aggregate {
+        using state_type = std::uint64_t;
+
+        constexpr state_type init() const noexcept { return std::numeric_limits<state_type>::max(); }
+        constexpr void add(state_type& state, std::uint64_t value) const noexcept { state = value < state ? value : state; }
+        constexpr void merge(state_type& state, const state_type& other) const noexcept { add(state, other); }
+    };
+
+    /**
+     * @brief Aggregator that finds the largest value field of each group
+     *
+     */
+    struct max_aggregate {
+        using state_type = std::uint64_t;
+
+        constexpr state_type init() const noexcept { return 0; }
+        constexpr void add(state_type& state, std::uint64_t value) const noexcept { state = value > state ? value : state; }
+        constexpr void merge(state_type& state, const state_type& other) const noexcept { add(state, other); }
+    };
+
+    /**
+     * @brief A single group produced by group_aggregate
+     *
+     * @tparam S The aggregator's state type
+     */
+    template<typename S>
+    struct group_entry {
+        /**
+         * @brief The key fields of the group, concatenated with the first key field in the most significant bits
+         *
+         */
+        std::uint64_t key;
+
+        /**
+         * @brief The number of records in the group
+         *
+         */
+        std::uint64_t count;
+
+        /**
+         * @brief The aggregated value of the group
+         *
+         */
+        S value;
+    };
+
+    namespace detail {
+        // Keys up to this width are aggregated into arrays indexed directly by the key rather than a hash table
+        constexpr size_t group_aggregate_direct_bits = 16;
+    }
+
+    /**
+     * @brief Groups a contiguous range of bitpacks by a subset of their fields and aggregates a value field per group.
+     *
+     * When the combined width of the key fields is small, groups are accumulated in arrays indexed directly by the key.
+     * Otherwise, a hash table is used. With more than one thread, each thread aggregates its own chunk and the partial
+     * results are merged at the end.
+     *
+     * An aggregator provides a state_type, and init(), add(state, value) and merge(state, other) members.
+     *
+     * @tparam KEY_FIELDS The indices (numeric or enum) of the key fields, most significant first
+     * @param range A contiguous range of bitpacks, such as a std::vector, std::array or std::span
+     * @param field The field being aggregated, passed as bitpack::value_field<I>
+     * @param agg The aggregator
+     * @param threads The number of threads to use. 0 uses one thread per hardware thread.
+     * @return std::vector<group_entry<typename A::state_type>> The non-empty groups, ordered by key
+     */
+    template<auto... KEY_FIELDS, typename R, auto V, typename A>
+    std::vector<group_entry<typename A::state_type>>
+    group_aggregate(R&& range, value_field_t<V> /* field */, const A& agg, size_t threads = 1) {
+        using pack_type  = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(range))>>;
+        using key        = detail::field_key<pack_type, KEY_FIELDS...>;
+        using state_type = typename A::state_type;
+        using entry_type = group_entry<state_type>;
+
+        const pack_type* const first = std::data(range);
+        const size_t n               = std::size(range);
+        threads                      = detail::resolve_thread_count(threads, n);
+
+        std::vector<entry_type> groups;
+        if constexpr(key::total_bits <= detail::group_aggregate_direct_bits) {
+            constexpr size_t slots = size_t(1) << key::total_bits;
+            std::vector<std::uint64_t> counts(threads * slots);
+            std::vector<state_type> states(threads * slots, agg.init());
+
+            detail::run_on_threads(threads, [&](size_t t) {
+                const auto [lo, hi]  = detail::thread_chunk(n, threads, t);
+                std::uint64_t* count = counts.data() + t * slots;
+                state_type* state    = states.data() + t * slots;
+                for(size_t i = lo; i < hi; ++i) {
+                    const auto k = static_cast<size_t>(key::of(first[i]));
+                    ++count[k];
+                    agg.add(state[k], static_cast<std::uint64_t>(first[i].template get<V>()));
+                }
+            });
+
+            for(size_t k = 0; k < slots; ++k) {
+                for(size_t t = 1; t < threads; ++t) {
+                    counts[k] += counts[t * slots + k];
+                    agg.merge(states[k], states[t * slots + k]);
+                }
+                if(counts[k] != 0) {
+                    groups.push_back(entry_type { k, counts[k], states[k] });
+                }
+            }
+        }
+        else {
+            using table_type = std::unordered_map<std::uint64_t, std::pair<std::uint64_t, state_type>>;
+            std::vector<table_type> tables(threads);
+
+            detail::run_on_threads(threads, [&](size_t t) {
+                const auto [lo, hi] = detail::thread_chunk(n, threads, t);
+                table_type& table   = tables[t];
+                for(size_t i = lo; i < hi; ++i) {
+                    auto it = table.try_emplace(key::of(first[i]), 0, agg.init()).first;
+                    ++it->second.first;
+                    agg.add(it->second.second, static_cast<std::uint64_t>(first[i].template get<V>()));
+                }
+            });
+
+            for(size_t t = 1; t < threads; ++t) {
+                for(const auto& [k, partial] : tables[t]) {
+                    auto it = tables[0].try_emplace(k, 0, agg.init()).first;
+                    it->second.first += partial.first;
+                    agg.merge(it->second.second, partial.second);
+                }
+            }
+
+            groups.reserve(tables[0].size());
+            for(const auto& [k, group] : tables[0]) {
+                groups.push_back(entry_type { k, group.first, group.second });
+            }
+            std::sort(groups.begin(), groups.end(), [](const entry_type& lhs, const entry_type& rhs) {
+                return lhs.key < rhs.key;
+            });
+        }
+        return groups;
+    }
+}
+
+#endif
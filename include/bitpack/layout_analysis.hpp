@@ -0,0 +1,206 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_LAYOUT_ANALYSIS_HPP
+#define BITPACK_LAYOUT_ANALYSIS_HPP
+
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <bitpack/detail/type_name.hpp>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <ostream>
+#include <string>
+
+namespace bitpack {
+    /**
+     * @brief Where one field of a layout lives in storage
+     *
+     */
+    struct field_analysis {
+        size_t width  = 0;
+        size_t offset = 0;
+        // The field's bits in storage
+        std::uint64_t mask = 0;
+        // Whether the field touches more bytes than its width needs
+        bool straddles_byte = false;
+        // Whether the field touches more 32 bit words than its width needs
+        bool straddles_word = false;
+        // The shifts and masks get and set apply to the storage word once it is loaded. A field at bit 0 needs no
+        // shift and a field at the top of the word needs no mask to read, and a field filling the word needs neither.
+        size_t get_ops = 0;
+        size_t set_ops = 0;
+    };
+
+    /**
+     * @brief A description of a layout: its size, the storage chosen for it, and where each field lives
+     *
+     * @tparam N The maximum number of fields
+     */
+    template<size_t N>
+    struct layout_analysis {
+        size_t field_count = 0;
+        size_t total_bits  = 0;
+        // The bits in the storage type the layout uses, and how many of them no field covers
+        size_t storage_bits = 0;
+        size_t wasted_bits  = 0;
+        // The bits in the storage type the default detector picks under each preference
+        size_t fast_storage_bits  = 0;
+        size_t small_storage_bits = 0;
+        std::array<field_analysis, N> fields {};
+
+        /**
+         * @brief Gets the bytes taken by an array of a million records under a storage preference
+         *
+         */
+        constexpr size_t bytes_per_million(storage_preference p) const noexcept {
+            return (p == storage_preference::FAST ? fast_storage_bits : small_storage_bits) / CHAR_BIT * 1000000;
+        }
+    };
+
+    namespace detail {
+        // The size in bits of the storage the default detector picks for a number of bits
+        constexpr size_t detected_storage_bits(storage_preference p, size_t bits) noexcept {
+            const bool fast = p == storage_preference::FAST;
+            size_t bytes    = 0;
+            if(bits <= 8) {
+                bytes = fast ? sizeof(std::uint_fast8_t) : sizeof(std::uint_least8_t);
+            }
+            else if(bits <= 16) {
+                bytes = fast ? sizeof(std::uint_fast16_t) : sizeof(std::uint_least16_t);
+            }
+            else if(bits <= 32) {
+                bytes = fast ? sizeof(std::uint_fast32_t) : sizeof(std::uint_least32_t);
+            }
+            else if(bits <= 64) {
+                bytes = fast ? sizeof(std::uint_fast64_t) : sizeof(std::uint_least64_t);
+            }
+            return bytes * CHAR_BIT;
+        }
+    }
+
+    /**
+     * @brief Analyzes the first count fields described by sizes and offsets
+     *
+     * @param sizes The width of each field
+     * @param offsets The offset of each field
+     * @param count The number of fields
+     * @param storage_bits The bits in the storage type, or 0 to use what the default detector picks for preference p
+     * @param p The storage preference
+     * @return layout_analysis<N> The analysis
+     */
+    template<size_t N>
+    constexpr layout_analysis<N> analyze_fields(const std::array<size_t, N>& sizes,
+                                                const std::array<size_t, N>& offsets,
+                                                size_t count,
+                                                size_t storage_bits,
+                                                storage_preference p) {
+        layout_analysis<N> result;
+        result.field_count = count;
+        for(size_t i = 0; i < count; ++i) {
+            field_analysis& field = result.fields[i];
+            field.width           = sizes[i];
+            field.offset          = offsets[i];
+            field.mask            = detail::low_mask(sizes[i]) << (sizes[i] == 0 ? 0 : offsets[i]);
+            const size_t last     = offsets[i] + sizes[i] - 1;
+            field.straddles_byte  = sizes[i] > 0 && last / 8 - offsets[i] / 8 + 1 > (sizes[i] + 7) / 8;
+            field.straddles_word  = sizes[i] > 0 && last / 32 - offsets[i] / 32 + 1 > (sizes[i] + 31) / 32;
+            result.total_bits += sizes[i];
+        }
+        result.fast_storage_bits  = detail::detected_storage_bits(storage_preference::FAST, result.total_bits);
+        result.small_storage_bits = detail::detected_storage_bits(storage_preference::SMALL, result.total_bits);
+        result.storage_bits       = storage_bits != 0 ? storage_bits : detail::detected_storage_bits(p, result.total_bits);
+        result.wasted_bits        = result.storage_bits - result.total_bits;
+        for(size_t i = 0; i < count; ++i) {
+            field_analysis& field = result.fields[i];
+            if(field.width == 0) {
+                continue;
+            }
+            const bool shifted = field.offset != 0;
+            const bool masked  = field.offset + field.width != result.storage_bits;
+            // Reading is a shift down and a mask; writing clears the field, shifts the value up and merges it in
+            field.get_ops = size_t(shifted) + size_t(masked);
+            field.set_ops = shifted || masked ? 2 + size_t(shifted) : 0;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Analyzes a layout at compile time
+     *
+     * @tparam L The layout
+     * @tparam D The storage detector whose choice is reported as storage_bits
+     */
+    template<typename L, template<storage_preference, size_t> typename D = layout_storage_detector>
+    constexpr layout_analysis<L::field_sizes.size()> analyze_layout() {
+        return analyze_fields(L::field_sizes,
+                              L::field_offsets,
+                              L::field_sizes.size(),
+                              sizeof(typename layout_traits<L, D>::storage_type) * CHAR_BIT,
+                              L::storage_preference);
+    }
+
+    /**
+     * @brief Writes an analysis as a human readable report
+     *
+     * @param out The stream to write to
+     * @param name The name of the layout
+     * @param analysis The analysis
+     */
+    template<size_t N>
+    void write_layout_analysis(std::ostream& out, const std::string& name, const layout_analysis<N>& analysis) {
+        const std::ios_base::fmtflags flags = out.flags();
+        out << name << "\n";
+        out << "  total bits:   " << analysis.total_bits << "\n";
+        out << "  storage bits: " << analysis.storage_bits << " (" << analysis.wasted_bits << " wasted)\n";
+        out << "  per million records: " << analysis.bytes_per_million(storage_preference::FAST) << " bytes fast, "
+            << analysis.bytes_per_million(storage_preference::SMALL) << " bytes small\n";
+        for(size_t i = 0; i < analysis.field_count; ++i) {
+            const field_analysis& field = analysis.fields[i];
+            out << "  field " << std::dec << i << ": width " << field.width << ", offset " << field.offset << ", mask 0x"
+                << std::hex << field.mask << std::dec;
+            if(field.straddles_word) {
+                out << ", straddles a 32 bit word";
+            }
+            else if(field.straddles_byte) {
+                out << ", straddles a byte";
+            }
+            out << ", get " << field.get_ops << " ops, set " << field.set_ops << " ops\n";
+        }
+        out.flags(flags);
+    }
+
+    /**
+     * @brief Writes a report for layout L
+     *
+     */
+    template<typename L, template<storage_preference, size_t> typename D = layout_storage_detector>
+    void write_layout_analysis(std::ostream& out) {
+        write_layout_analysis(out, detail::type_name<L>(), analyze_layout<L, D>());
+    }
+}
+
+#endif
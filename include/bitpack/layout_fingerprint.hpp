@@ -0,0 +1,166 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_LAYOUT_FINGERPRINT_HPP
+#define BITPACK_LAYOUT_FINGERPRINT_HPP
+
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bitpack {
+    namespace detail {
+        constexpr std::uint64_t fnv1a_offset_basis = 0xcbf29ce484222325;
+        constexpr std::uint64_t fnv1a_prime        = 0x100000001b3;
+
+        // Hashes the low bytes of value into hash, least significant byte first
+        constexpr std::uint64_t fnv1a(std::uint64_t hash, std::uint64_t value, size_t bytes) noexcept {
+            for(size_t i = 0; i < bytes; ++i, value >>= 8) {
+                hash ^= value & 0xFF;
+                hash *= fnv1a_prime;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Hashes a field tag. Constant tags such as field_tag<fields::ID> hash their value, so renaming the enum
+         * keeps the fingerprint.
+         *
+         */
+        template<typename TAG>
+        constexpr std::uint64_t hash_field_tag(std::uint64_t hash) noexcept {
+            if constexpr(std::is_void_v<TAG>) {
+                return fnv1a(hash, 0, 1);
+            }
+            else {
+                using value_type = typename TAG::value_type;
+                if constexpr(std::is_enum_v<value_type>) {
+                    const auto value = static_cast<std::underlying_type_t<value_type>>(TAG::value);
+                    return fnv1a(fnv1a(hash, 1, 1), static_cast<std::uint64_t>(value), 8);
+                }
+                else {
+                    return fnv1a(fnv1a(hash, 1, 1), static_cast<std::uint64_t>(TAG::value), 8);
+                }
+            }
+        }
+
+        template<typename L, size_t... Is>
+        constexpr std::uint64_t layout_fingerprint(std::index_sequence<Is...>) noexcept {
+            std::uint64_t hash = fnv1a(fnv1a_offset_basis, sizeof...(Is), 2);
+            ((hash = fnv1a(fnv1a(hash, L::field_sizes[Is], 2), L::field_offsets[Is], 2)), ...);
+            ((hash = hash_field_tag<layout_field_tag_t<L, Is>>(hash)), ...);
+            return hash;
+        }
+
+        template<size_t N>
+        constexpr bool distinct_fingerprints(const std::array<std::uint64_t, N>& fingerprints) noexcept {
+            for(size_t i = 0; i < N; ++i) {
+                for(size_t j = i + 1; j < N; ++j) {
+                    if(fingerprints[i] == fingerprints[j]) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief A 64 bit FNV-1a hash of the width, offset and tag of every field of layout L. Layouts that place the same
+     * fields at the same offsets share a fingerprint, so comparing fingerprints is enough to tell whether stored records
+     * can be read with L. Tags are field_tag constants, so they hash the same on every compiler.
+     *
+     * @tparam L The layout
+     */
+    template<typename L>
+    struct layout_fingerprint {
+        /**
+         * @brief The fingerprint
+         *
+         */
+        static constexpr std::uint64_t value = detail::layout_fingerprint<L>(std::make_index_sequence<L::field_sizes.size()>());
+    };
+
+    /**
+     * @brief Helper alias for layout_fingerprint<L>::value
+     *
+     * @tparam L The layout
+     */
+    template<typename L>
+    constexpr std::uint64_t layout_fingerprint_v = layout_fingerprint<L>::value;
+
+    /**
+     * @brief The current layout of a record type along with the older layouts it can still be read from
+     *
+     * @tparam L The current layout
+     * @tparam OLD The older layouts, in any order
+     */
+    template<typename L, typename... OLD>
+    struct layout_history {
+        /**
+         * @brief The current layout
+         *
+         */
+        using current = L;
+
+        /**
+         * @brief The number of layouts in the history, including the current one
+         *
+         */
+        static constexpr size_t version_count = sizeof...(OLD) + 1;
+
+        /**
+         * @brief The fingerprint of each layout. Version 0 is the current layout and version k is the k-th older one.
+         *
+         */
+        static constexpr std::array<std::uint64_t, version_count> fingerprints = { layout_fingerprint_v<L>,
+                                                                                   layout_fingerprint_v<OLD>... };
+
+        /**
+         * @brief The layout of version V
+         *
+         */
+        template<size_t V>
+        using version = std::tuple_element_t<V, std::tuple<L, OLD...>>;
+
+        /**
+         * @brief Finds the version with a fingerprint
+         *
+         * @param fingerprint The fingerprint
+         * @return constexpr size_t The version, or version_count if the fingerprint is unknown
+         */
+        static constexpr size_t find(std::uint64_t fingerprint) noexcept {
+            size_t v = 0;
+            while(v < version_count && fingerprints[v] != fingerprint) { ++v; }
+            return v;
+        }
+
+        static_assert(detail::distinct_fingerprints(fingerprints), "The layouts of a history must have distinct fingerprints");
+    };
+}
+
+#endif
@@ -0,0 +1,408 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_MMAP_PACKED_ARRAY_HPP
+#define BITPACK_MMAP_PACKED_ARRAY_HPP
+
+#include <bitpack/bitpack.hpp>
+#include <bitpack/layout_fingerprint.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#else
+#    error "mmap_packed_array requires a POSIX system"
+#endif
+
+namespace bitpack {
+    /**
+     * @brief The result of opening or writing a packed record file
+     *
+     */
+    enum class packed_file_status {
+        OK,
+        OPEN_FAILED,
+        MAPPING_FAILED,
+        WRITE_FAILED,
+        BAD_HEADER,
+        SCHEMA_MISMATCH,
+        TRUNCATED
+    };
+
+    /**
+     * @brief How a packed record file is mapped
+     *
+     */
+    enum class map_mode {
+        READ_ONLY,
+        READ_WRITE
+    };
+
+    namespace detail {
+        /*
+
+            Packed record files start with a header describing the layout, followed by the raw storage of each record
+            starting at a 64 byte boundary. All header fields are little endian:
+
+                0   char[8]   magic "BITPACK2"
+                8   uint32    offset of the first record
+                12  uint16    number of fields
+                14  uint8     field order (0 = LSB_FIRST, 1 = MSB_FIRST)
+                15  uint8     bytes per record
+                16  uint64    number of records
+                24  uint64    schema fingerprint (see packed_file_schema)
+                32  uint16[]  width of each field, in field order
+
+            Readers only compare the schema fingerprint; the other layout fields are kept for tools that inspect files.
+
+            Records are stored in host byte order; files written on a host with a different byte order fail to open.
+
+        */
+
+        constexpr char packed_file_magic[8]       = { 'B', 'I', 'T', 'P', 'A', 'C', 'K', '2' };
+        constexpr size_t packed_file_fixed_bytes  = 32;
+        constexpr size_t packed_file_record_align = 64;
+
+        inline void put_le(std::vector<std::uint8_t>& out, std::uint64_t value, size_t bytes) {
+            for(size_t i = 0; i < bytes; ++i, value >>= 8) { out.push_back(static_cast<std::uint8_t>(value)); }
+        }
+
+        inline std::uint64_t get_le(const std::uint8_t* in, size_t bytes) noexcept {
+            std::uint64_t value = 0;
+            for(size_t i = bytes; i-- > 0;) { value = (value << 8) | in[i]; }
+            return value;
+        }
+
+        constexpr bool host_is_little_endian() noexcept {
+#if defined(__BYTE_ORDER__)
+            return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+#else
+            return true;
+#endif
+        }
+
+        /**
+         * @brief The schema fingerprint of a packed record file holding records of bitpack type P. It extends the layout
+         * fingerprint with the size and byte order of the storage, so that one compare validates the whole header.
+         *
+         */
+        template<typename P>
+        constexpr std::uint64_t packed_file_schema() noexcept {
+            const std::uint64_t hash = fnv1a(layout_fingerprint_v<typename P::layout_type>, sizeof(typename P::storage_type), 1);
+            return fnv1a(hash, host_is_little_endian() ? 1 : 0, 1);
+        }
+
+        /**
+         * @brief Builds the header of a packed record file holding count records of bitpack type P
+         *
+         */
+        template<typename P>
+        std::vector<std::uint8_t> packed_file_header(std::uint64_t count) {
+            using layout_type = typename P::layout_type;
+            const size_t fields = layout_type::field_sizes.size();
+            const size_t used   = packed_file_fixed_bytes + 2 * fields;
+            const size_t offset = (used + packed_file_record_align - 1) / packed_file_record_align * packed_file_record_align;
+
+            std::vector<std::uint8_t> header(std::begin(packed_file_magic), std::end(packed_file_magic));
+            put_le(header, offset, 4);
+            put_le(header, fields, 2);
+            put_le(header, layout_type::field_order == field_order::MSB_FIRST ? 1 : 0, 1);
+            put_le(header, sizeof(typename P::storage_type), 1);
+            put_le(header, count, 8);
+            put_le(header, packed_file_schema<P>(), 8);
+            for(const size_t width : layout_type::field_sizes) { put_le(header, width, 2); }
+            header.resize(offset, 0);
+            return header;
+        }
+
+        /**
+         * @brief Checks a mapped header against bitpack type P
+         *
+         * @param data The start of the file
+         * @param size The size of the file in bytes
+         * @param offset Set to the offset of the first record
+         * @param count Set to the number of records
+         * @return packed_file_status OK if the file holds records of type P
+         */
+        template<typename P>
+        packed_file_status
+        check_packed_file_header(const std::uint8_t* data, size_t size, size_t& offset, size_t& count) noexcept {
+            if(size < packed_file_fixed_bytes || std::memcmp(data, packed_file_magic, sizeof(packed_file_magic)) != 0) {
+                return packed_file_status::BAD_HEADER;
+            }
+            offset              = static_cast<size_t>(get_le(data + 8, 4));
+            const size_t fields = static_cast<size_t>(get_le(data + 12, 2));
+            if(offset < packed_file_fixed_bytes + 2 * fields || offset > size) {
+                return packed_file_status::BAD_HEADER;
+            }
+            if(get_le(data + 24, 8) != packed_file_schema<P>()) {
+                return packed_file_status::SCHEMA_MISMATCH;
+            }
+            count = static_cast<size_t>(get_le(data + 16, 8));
+            if((size - offset) / sizeof(P) < count) {
+                return packed_file_status::TRUNCATED;
+            }
+            return packed_file_status::OK;
+        }
+
+        /**
+         * @brief Maps a whole packed record file
+         *
+         * @param path The path of the file
+         * @param writable Whether the mapping can be written to
+         * @param mapping Set to the start of the mapping
+         * @param length Set to the length of the mapping
+         * @return packed_file_status OK on success
+         */
+        inline packed_file_status map_packed_file(const char* path, bool writable, void*& mapping, size_t& length) noexcept {
+            const int fd = ::open(path, writable ? O_RDWR : O_RDONLY);
+            if(fd < 0) {
+                return packed_file_status::OPEN_FAILED;
+            }
+            struct stat info {};
+            if(::fstat(fd, &info) != 0) {
+                ::close(fd);
+                return packed_file_status::OPEN_FAILED;
+            }
+            if(static_cast<size_t>(info.st_size) < packed_file_fixed_bytes) {
+                ::close(fd);
+                return packed_file_status::BAD_HEADER;
+            }
+            length  = static_cast<size_t>(info.st_size);
+            mapping = ::mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            return mapping == MAP_FAILED ? packed_file_status::MAPPING_FAILED : packed_file_status::OK;
+        }
+    }
+
+    /**
+     * @brief Writes records to a packed record file that can be opened with mmap_packed_array
+     *
+     * @param path The path of the file, which is replaced if it exists
+     * @param records A contiguous range of bitpacks
+     * @return packed_file_status OK on success
+     */
+    template<typename R>
+    packed_file_status write_packed_file(const char* path, const R& records) {
+        using pack_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(records))>>;
+        const auto header = detail::packed_file_header<pack_type>(std::size(records));
+
+        std::FILE* file = std::fopen(path, "wb");
+        if(file == nullptr) {
+            return packed_file_status::OPEN_FAILED;
+        }
+        bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+        // An empty range may have no data pointer at all, which fwrite doesn't accept
+        if(std::size(records) > 0) {
+            ok = ok && std::fwrite(std::data(records), sizeof(pack_type), std::size(records), file) == std::size(records);
+        }
+        ok      = std::fclose(file) == 0 && ok;
+        return ok ? packed_file_status::OK : packed_file_status::WRITE_FAILED;
+    }
+
+    /**
+     * @brief A memory mapped array of bitpacks stored in a packed record file.
+     *
+     * Opening maps the file and checks its header against the layout, so records are accessed in place without being
+     * read or copied. Files whose layout does not match fail to open.
+     *
+     * @tparam L The layout of the records
+     * @tparam D The storage detector
+     */
+    template<typename L, template<storage_preference, size_t> typename D = layout_storage_detector>
+    class mmap_packed_array {
+    public:
+        /**
+         * @brief The type of the records
+         *
+         */
+        using value_type = bitpack<L, D>;
+
+        static_assert(sizeof(value_type) == sizeof(typename value_type::storage_type) &&
+                          std::is_trivially_copyable_v<value_type>,
+                      "bitpacks must be stored as their raw storage to be memory mapped");
+
+        mmap_packed_array() = default;
+
+        mmap_packed_array(const mmap_packed_array&)            = delete;
+        mmap_packed_array& operator=(const mmap_packed_array&) = delete;
+
+        mmap_packed_array(mmap_packed_array&& other) noexcept { *this = std::move(other); }
+
+        mmap_packed_array& operator=(mmap_packed_array&& other) noexcept {
+            if(this != &other) {
+                close();
+                _mapping  = std::exchange(other._mapping, nullptr);
+                _length   = std::exchange(other._length, 0);
+                _records  = std::exchange(other._records, nullptr);
+                _size     = std::exchange(other._size, 0);
+                _writable = std::exchange(other._writable, false);
+            }
+            return *this;
+        }
+
+        ~mmap_packed_array() { close(); }
+
+        /**
+         * @brief Creates a packed record file holding count zeroed records and maps it read-write
+         *
+         * @param path The path of the file, which is replaced if it exists
+         * @param count The number of records
+         * @return packed_file_status OK on success
+         */
+        packed_file_status create(const char* path, size_t count) {
+            const auto header = detail::packed_file_header<value_type>(count);
+            const int fd      = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if(fd < 0) {
+                return packed_file_status::OPEN_FAILED;
+            }
+            const bool ok = ::write(fd, header.data(), header.size()) == static_cast<ssize_t>(header.size()) &&
+                            ::ftruncate(fd, static_cast<off_t>(header.size() + count * sizeof(value_type))) == 0;
+            ::close(fd);
+            return ok ? open(path, map_mode::READ_WRITE) : packed_file_status::WRITE_FAILED;
+        }
+
+        /**
+         * @brief Maps a packed record file and checks its header against the layout
+         *
+         * @param path The path of the file
+         * @param mode Whether the records can be modified. Modifications are written back to the file.
+         * @return packed_file_status OK on success
+         */
+        packed_file_status open(const char* path, map_mode mode = map_mode::READ_ONLY) {
+            close();
+            const bool writable = mode == map_mode::READ_WRITE;
+            void* mapping       = nullptr;
+            size_t length       = 0;
+            auto status         = detail::map_packed_file(path, writable, mapping, length);
+            if(status != packed_file_status::OK) {
+                return status;
+            }
+
+            size_t offset     = 0;
+            size_t count      = 0;
+            const auto* bytes = static_cast<const std::uint8_t*>(mapping);
+            status            = detail::check_packed_file_header<value_type>(bytes, length, offset, count);
+            if(status != packed_file_status::OK) {
+                ::munmap(mapping, length);
+                return status;
+            }
+
+            _mapping  = mapping;
+            _length   = length;
+            _records  = reinterpret_cast<value_type*>(static_cast<std::uint8_t*>(mapping) + offset);
+            _size     = count;
+            _writable = writable;
+            return packed_file_status::OK;
+        }
+
+        /**
+         * @brief Unmaps the file. Changes made through a read-write mapping have already been written to it.
+         *
+         */
+        void close() noexcept {
+            if(_mapping != nullptr) {
+                ::munmap(_mapping, _length);
+            }
+            _mapping  = nullptr;
+            _length   = 0;
+            _records  = nullptr;
+            _size     = 0;
+            _writable = false;
+        }
+
+        /**
+         * @brief Flushes changes made through a read-write mapping to disk
+         *
+         * @return true On success
+         */
+        bool sync() noexcept { return _mapping == nullptr || ::msync(_mapping, _length, MS_SYNC) == 0; }
+
+        bool is_open() const noexcept { return _mapping != nullptr; }
+        bool is_writable() const noexcept { return _writable; }
+        size_t size() const noexcept { return _size; }
+        bool empty() const noexcept { return _size == 0; }
+
+        const value_type* data() const noexcept { return _records; }
+        const value_type* begin() const noexcept { return _records; }
+        const value_type* end() const noexcept { return _records + _size; }
+
+        /**
+         * @brief Gets the records of a read-write mapping
+         *
+         */
+        value_type* mutable_data() noexcept {
+            assert(_writable && "The packed record file is mapped read-only");
+            return _records;
+        }
+
+        const value_type& operator[](size_t idx) const noexcept {
+            assert(idx < _size && "mmap_packed_array index out of range");
+            return _records[idx];
+        }
+
+        /**
+         * @brief Gets field I of record idx, in place
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param idx The index of the record
+         */
+        template<auto I>
+        auto get(size_t idx) const noexcept {
+            return (*this)[idx].template get<I>();
+        }
+
+        /**
+         * @brief Sets field I of record idx, in place. The file must be mapped read-write.
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param idx The index of the record
+         * @param value The value of the field
+         */
+        template<auto I, typename V>
+        void set(size_t idx, V value) noexcept {
+            assert(idx < _size && "mmap_packed_array index out of range");
+            mutable_data()[idx].template set<I>(value);
+        }
+
+    private:
+        void* _mapping       = nullptr;
+        size_t _length       = 0;
+        value_type* _records = nullptr;
+        size_t _size         = 0;
+        bool _writable       = false;
+    };
+}
+
+#endif
@@ -0,0 +1,188 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_OPTIMIZED_LAYOUT_HPP
+#define BITPACK_OPTIMIZED_LAYOUT_HPP
+
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <climits>
+#include <cstddef>
+#include <tuple>
+
+namespace bitpack {
+    /**
+     * @brief Hints for optimized_layout: a storage preference and the fields that are accessed most, hottest first
+     *
+     * @tparam P The users preference for fast or small storage
+     * @tparam HOT_FIELDS The indices (numeric or enum) of the hot fields
+     */
+    template<storage_preference P, auto... HOT_FIELDS>
+    struct layout_hints {
+        static constexpr ::bitpack::storage_preference storage_preference = P;
+        static constexpr std::array<size_t, sizeof...(HOT_FIELDS)> hot_fields = { detail::index_to_sizet<HOT_FIELDS>()... };
+    };
+
+    namespace detail {
+        /*
+
+            optimized_layout keeps the declared field indices but places fields in storage to make the common accesses
+            cheap:
+
+                - The hottest field goes at bit 0, so reading it is a single mask.
+                - The second hottest field goes at the top of the storage word chosen by the default storage detector, so
+                  reading it is a single shift.
+                - Further hot fields follow the hottest one, in hint order.
+                - The remaining fields are placed greedily: at each position, the field that touches the fewest bytes
+                  beyond its own size, and doesn't cross the middle of the storage word, goes next. Ties go to the widest
+                  field, then to the lowest index.
+
+        */
+
+        // Extra bytes touched by a field of width w at offset o beyond the bytes it needs, plus a penalty when it crosses
+        // the middle of the storage word
+        constexpr size_t straddle_cost(size_t offset, size_t width, size_t storage_bits) noexcept {
+            if(width == 0) {
+                return 0;
+            }
+            const size_t bytes_touched = (offset + width - 1) / 8 - offset / 8 + 1;
+            const size_t bytes_needed  = (width + 7) / 8;
+            const size_t half          = storage_bits / 2;
+            const bool crosses_half    = storage_bits > 8 && offset < half && offset + width > half;
+            return (bytes_touched - bytes_needed) + (crosses_half ? 4 : 0);
+        }
+
+        template<size_t N, size_t H>
+        constexpr std::array<size_t, N> optimized_offsets(const std::array<size_t, N>& sizes,
+                                                          const std::array<size_t, H>& hot,
+                                                          size_t storage_bits) {
+            std::array<size_t, N> offsets {};
+            std::array<bool, N> placed {};
+            size_t low = 0;
+            for(size_t h = 0; h < H; ++h) {
+                const size_t i = hot[h];
+                if(h == 1) {
+                    offsets[i] = storage_bits - sizes[i];
+                }
+                else {
+                    offsets[i] = low;
+                    low += sizes[i];
+                }
+                placed[i] = true;
+            }
+            for(size_t remaining = N - H; remaining > 0; --remaining) {
+                size_t best = N;
+                for(size_t i = 0; i < N; ++i) {
+                    if(placed[i]) {
+                        continue;
+                    }
+                    if(best == N) {
+                        best = i;
+                        continue;
+                    }
+                    const size_t cost      = straddle_cost(low, sizes[i], storage_bits);
+                    const size_t best_cost = straddle_cost(low, sizes[best], storage_bits);
+                    if(cost < best_cost || (cost == best_cost && sizes[i] > sizes[best])) {
+                        best = i;
+                    }
+                }
+                offsets[best] = low;
+                low += sizes[best];
+                placed[best] = true;
+            }
+            return offsets;
+        }
+
+        template<size_t N, size_t H>
+        constexpr bool distinct_hot_fields(const std::array<size_t, H>& hot) {
+            for(size_t h = 0; h < H; ++h) {
+                if(hot[h] >= N) {
+                    return false;
+                }
+                for(size_t k = 0; k < h; ++k) {
+                    if(hot[k] == hot[h]) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Layout type that keeps the declared field indices but rearranges the fields in storage to suit the hot
+     * fields named in its hints (see detail::optimized_offsets). Fields are found through field_offsets, so bitpack's
+     * get and set work unchanged. field_order is LSB_FIRST only in the sense that the raw storage isn't sortable.
+     * Fields are placed within the storage word the default detector picks, and bitpack rejects a custom detector
+     * whose storage is too narrow to reach them.
+     *
+     * @tparam HINTS A layout_hints type
+     * @tparam FIELDS The fields of the layout, in declared order
+     */
+    template<typename HINTS, typename... FIELDS>
+    struct optimized_layout {
+        static_assert((is_bitwidth_v<FIELDS> && ... && true), "layout fields must be a bitwidth type.");
+        static_assert(detail::distinct_hot_fields<sizeof...(FIELDS)>(HINTS::hot_fields),
+                      "Hot fields must be distinct indices of the layout's fields");
+
+        /**
+         * @brief The storage preference (fast or small)
+         *
+         */
+        static constexpr ::bitpack::storage_preference storage_preference = HINTS::storage_preference;
+
+        /**
+         * @brief The order fields are placed in storage
+         *
+         */
+        static constexpr ::bitpack::field_order field_order = ::bitpack::field_order::LSB_FIRST;
+
+        /**
+         * @brief The width in bits of each field in the layout, in declared order
+         *
+         */
+        static constexpr std::array<size_t, sizeof...(FIELDS)> field_sizes = { FIELDS::width... };
+
+        /**
+         * @brief The number of bits in the storage word the default detector picks for these fields
+         *
+         */
+        static constexpr size_t storage_bits =
+            sizeof(typename layout_storage_detector<HINTS::storage_preference, (FIELDS::width + ... + 0)>::type) * CHAR_BIT;
+
+        /**
+         * @brief The offset in bits of each field in the layout, in declared order
+         *
+         */
+        static constexpr std::array<size_t, sizeof...(FIELDS)> field_offsets =
+            detail::optimized_offsets(field_sizes, HINTS::hot_fields, storage_bits);
+
+        /**
+         * @brief The tag of each field in the layout, in declared order
+         *
+         */
+        using field_tags = std::tuple<typename FIELDS::tag...>;
+    };
+}
+
+#endif
@@ -0,0 +1,277 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_PFOR_CODEC_HPP
+#define BITPACK_PFOR_CODEC_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/detail/bits.hpp>
+#include <bitpack/for_codec.hpp>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    namespace detail {
+        /**
+         * @brief Picks the packed width that minimizes the total bits of a block, given how many of its deltas need each
+         * width. Deltas wider than the chosen width become exceptions costing exception_bits each.
+         *
+         * @param width_counts The number of deltas whose bit_width is each index
+         * @param count The number of deltas in the block
+         * @param max_width The widest possible delta
+         * @param exception_bits The cost of one exception in bits
+         * @return size_t The chosen width
+         */
+        template<size_t N>
+        constexpr size_t pfor_best_width(const std::array<size_t, N>& width_counts,
+                                         size_t count,
+                                         size_t max_width,
+                                         size_t exception_bits) noexcept {
+            size_t best_width = max_width;
+            size_t best_cost  = count * max_width;
+            size_t exceptions = 0;
+            for(size_t w = max_width; w-- > 0;) {
+                exceptions += width_counts[w + 1];
+                const size_t cost = count * w + exceptions * exception_bits;
+                if(cost < best_cost) {
+                    best_cost  = cost;
+                    best_width = w;
+                }
+            }
+            return best_width;
+        }
+    }
+
+    /**
+     * @brief A column of unsigned integers compressed with patched frame of reference (PFOR) bit packing.
+     *
+     * Like for_column, each block stores a base and packs the distance of each value from it. The width is chosen to
+     * minimize the total size of the block, so a few outliers do not force every value to a wide width. Outliers store
+     * their low bits in the packed block and their high bits in a separate exception list along with their position.
+     * Decoding unpacks the whole block without branches and then patches in the exceptions.
+     *
+     * @tparam T The unsigned integer type of the values
+     * @tparam BLOCK_SIZE The number of values per block, either 128 or 256
+     */
+    template<typename T = std::uint64_t, size_t BLOCK_SIZE = 128>
+    class pfor_column {
+        static_assert(std::is_unsigned_v<T>, "pfor_column values must be unsigned integers");
+        static_assert(BLOCK_SIZE == 128 || BLOCK_SIZE == 256, "pfor_column blocks must be 128 or 256 values");
+
+        static constexpr size_t max_width = std::numeric_limits<T>::digits;
+
+    public:
+        /**
+         * @brief The type of the values
+         *
+         */
+        using value_type = T;
+
+        /**
+         * @brief The number of values per block
+         *
+         */
+        static constexpr size_t block_size = BLOCK_SIZE;
+
+        /**
+         * @brief Constructs an empty column
+         *
+         */
+        pfor_column() = default;
+
+        /**
+         * @brief Constructs a column by encoding n values
+         *
+         * @param values The values
+         * @param n The number of values
+         */
+        pfor_column(const T* values, size_t n) : _size(n) {
+            static constexpr auto packers =
+                detail::for_packers<BLOCK_SIZE, T>(std::make_index_sequence<max_width + 1>());
+
+            _blocks.reserve(block_count());
+            std::array<T, BLOCK_SIZE> padded {};
+            for(size_t first = 0; first < n; first += BLOCK_SIZE) {
+                const size_t count = std::min(BLOCK_SIZE, n - first);
+                const T* src       = values + first;
+                const T base       = *std::min_element(src, src + count);
+
+                std::array<size_t, max_width + 1> width_counts {};
+                for(size_t i = 0; i < count; ++i) { ++width_counts[detail::bit_width(src[i] - base)]; }
+                const size_t width =
+                    detail::pfor_best_width(width_counts, BLOCK_SIZE, max_width, sizeof(std::uint8_t) * CHAR_BIT + max_width);
+
+                const block header { base, _words.size(), _positions.size(), static_cast<std::uint8_t>(width) };
+                for(size_t i = 0; i < count; ++i) {
+                    const std::uint64_t delta = static_cast<std::uint64_t>(src[i] - base);
+                    if(width < 64 && (delta >> width) != 0) {
+                        _positions.push_back(static_cast<std::uint8_t>(i));
+                        _exceptions.push_back(static_cast<T>(delta >> width));
+                    }
+                }
+
+                if(count < BLOCK_SIZE) {
+                    std::copy(src, src + count, padded.begin());
+                    std::fill(padded.begin() + count, padded.end(), base);
+                    src = padded.data();
+                }
+
+                _words.resize(_words.size() + BLOCK_SIZE * width / 64);
+                packers[width](src, base, _words.data() + header.offset);
+                _blocks.push_back(header);
+            }
+        }
+
+        /**
+         * @brief Constructs a column by encoding a contiguous range of values
+         *
+         * @param values The values
+         */
+        template<typename R, typename = std::enable_if_t<!std::is_pointer_v<std::decay_t<R>>>>
+        explicit pfor_column(const R& values) : pfor_column(std::data(values), std::size(values)) { }
+
+        /**
+         * @brief Gets the number of values in the column
+         *
+         */
+        size_t size() const noexcept { return _size; }
+
+        /**
+         * @brief Gets the number of blocks in the column
+         *
+         */
+        size_t block_count() const noexcept { return (_size + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+        /**
+         * @brief Gets the width in bits that values in block b are packed at
+         *
+         */
+        size_t block_width(size_t b) const noexcept { return _blocks[b].width; }
+
+        /**
+         * @brief Gets the number of exceptions in block b
+         *
+         */
+        size_t block_exceptions(size_t b) const noexcept { return _exceptions_end(b) - _blocks[b].exceptions; }
+
+        /**
+         * @brief Gets the number of bytes used by the encoded column, including block headers and exceptions
+         *
+         */
+        size_t size_in_bytes() const noexcept {
+            return _words.size() * sizeof(std::uint64_t) + _blocks.size() * sizeof(block) + _positions.size() +
+                   _exceptions.size() * sizeof(T);
+        }
+
+        /**
+         * @brief Decodes a single value without decoding its block
+         *
+         * @param i The index of the value
+         * @return T The value
+         */
+        T operator[](size_t i) const noexcept {
+            assert(i < _size && "pfor_column index out of range");
+            const size_t b      = i / BLOCK_SIZE;
+            const block& header = _blocks[b];
+            const auto position = static_cast<std::uint8_t>(i % BLOCK_SIZE);
+            std::uint64_t delta = detail::read_packed(_words.data() + header.offset, header.width, position);
+
+            const auto first = _positions.begin() + static_cast<std::ptrdiff_t>(header.exceptions);
+            const auto last  = _positions.begin() + static_cast<std::ptrdiff_t>(_exceptions_end(b));
+            const auto it    = std::lower_bound(first, last, position);
+            if(it != last && *it == position) {
+                delta |= static_cast<std::uint64_t>(_exceptions[static_cast<size_t>(it - _positions.begin())]) << header.width;
+            }
+            return static_cast<T>(header.base + delta);
+        }
+
+        /**
+         * @brief Decodes block b into out, which must have room for block_size values. Entries past the end of the
+         * column are set to the block's base.
+         *
+         * @param b The index of the block
+         * @param out The decoded values
+         */
+        void decode_block(size_t b, T* out) const noexcept {
+            static constexpr auto unpackers =
+                detail::for_unpackers<BLOCK_SIZE, T>(std::make_index_sequence<max_width + 1>());
+            const block& header = _blocks[b];
+            unpackers[header.width](_words.data() + header.offset, header.base, out);
+
+            // Exceptions only exist below the maximum width, so the shift is always in range
+            const size_t last = _exceptions_end(b);
+            for(size_t e = header.exceptions; e < last; ++e) {
+                out[_positions[e]] += static_cast<T>(_exceptions[e] << header.width);
+            }
+        }
+
+        /**
+         * @brief Decodes the whole column into out, which must have room for size() values
+         *
+         * @param out The decoded values
+         */
+        void decode(T* out) const noexcept {
+            const size_t full = _size / BLOCK_SIZE;
+            for(size_t b = 0; b < full; ++b) {
+                decode_block(b, out + b * BLOCK_SIZE);
+            }
+            if(full != block_count()) {
+                std::array<T, BLOCK_SIZE> tail;
+                decode_block(full, tail.data());
+                std::copy(tail.begin(), tail.begin() + (_size - full * BLOCK_SIZE), out + full * BLOCK_SIZE);
+            }
+        }
+
+    private:
+        /**
+         * @brief The header of a block
+         *
+         */
+        struct block {
+            T base;
+            size_t offset;
+            size_t exceptions;
+            std::uint8_t width;
+        };
+
+        std::vector<std::uint64_t> _words;
+        std::vector<block> _blocks;
+        std::vector<std::uint8_t> _positions;
+        std::vector<T> _exceptions;
+        size_t _size = 0;
+
+        size_t _exceptions_end(size_t b) const noexcept {
+            return b + 1 < _blocks.size() ? _blocks[b + 1].exceptions : _positions.size();
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,182 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_RADIX_SORT_HPP
+#define BITPACK_RADIX_SORT_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/field_key.hpp>
+#include <bitpack/detail/threads.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace bitpack {
+    namespace detail {
+        /**
+         * @brief Splits the key built from a subset of a bitpack's fields into the digits sorted by each radix pass
+         *
+         * @tparam P The bitpack type
+         * @tparam FIELDS The indices of the fields that make up the key
+         */
+        template<typename P, auto... FIELDS>
+        struct radix_key : field_key<P, FIELDS...> {
+            using field_key<P, FIELDS...>::total_bits;
+
+            /**
+             * @brief The largest digit used by a single pass. 11 bits keeps a histogram within the L1 cache.
+             *
+             */
+            static constexpr size_t max_digit_bits = 11;
+
+            /**
+             * @brief The number of passes needed to sort by the key
+             *
+             */
+            static constexpr size_t digit_count = (total_bits + max_digit_bits - 1) / max_digit_bits;
+
+            /**
+             * @brief The width of each digit, spread evenly across the passes
+             *
+             */
+            static constexpr size_t digit_bits = digit_count == 0 ? 0 : (total_bits + digit_count - 1) / digit_count;
+
+            /**
+             * @brief The number of buckets in each pass
+             *
+             */
+            static constexpr size_t bucket_count = size_t(1) << digit_bits;
+
+            static constexpr size_t digit(std::uint64_t key, size_t d) noexcept {
+                return static_cast<size_t>(key >> (d * digit_bits)) & (bucket_count - 1);
+            }
+        };
+    }
+
+    /**
+     * @brief Stable LSD radix sort of a contiguous range of bitpacks, ordered lexicographically by the given fields.
+     *
+     * The number of passes and the width of each digit are derived from the key fields' widths at compile time. Passes
+     * where every element falls in the same bucket are skipped.
+     *
+     * @tparam FIELDS The indices (numeric or enum) of the key fields, most significant first
+     * @param range A contiguous range of bitpacks, such as a std::vector, std::array or std::span
+     * @param threads The number of threads to use. 0 uses one thread per hardware thread.
+     */
+    template<auto... FIELDS, typename R>
+    void radix_sort(R&& range, size_t threads = 1) {
+        using pack_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(range))>>;
+        using key       = detail::radix_key<pack_type, FIELDS...>;
+        constexpr size_t buckets = key::bucket_count;
+        constexpr size_t digits  = key::digit_count;
+
+        pack_type* const first = std::data(range);
+        const size_t n         = std::size(range);
+        if(n < 2 || digits == 0) {
+            return;
+        }
+
+        threads = detail::resolve_thread_count(threads, n);
+
+        // Per thread histograms of every digit. The totals do not depend on element order, so they are computed once and
+        // used to skip passes where every element falls in the same bucket.
+        std::vector<size_t> local(threads * digits * buckets);
+        detail::run_on_threads(threads, [&](size_t t) {
+            const auto [lo, hi] = detail::thread_chunk(n, threads, t);
+            size_t* hist        = local.data() + t * digits * buckets;
+            for(size_t i = lo; i < hi; ++i) {
+                const std::uint64_t k = key::of(first[i]);
+                for(size_t d = 0; d < digits; ++d) { ++hist[d * buckets + key::digit(k, d)]; }
+            }
+        });
+
+        std::vector<size_t> totals(digits * buckets);
+        for(size_t t = 0; t < threads; ++t) {
+            for(size_t b = 0; b < totals.size(); ++b) { totals[b] += local[t * digits * buckets + b]; }
+        }
+
+        std::vector<pack_type> buffer(n);
+        pack_type* src = first;
+        pack_type* dst = buffer.data();
+
+        // Offsets each thread scatters its chunk into. Thread t writes after every earlier thread in each bucket, which
+        // keeps the sort stable.
+        std::vector<size_t> offsets(threads * buckets);
+        std::vector<size_t> chunk_hist(threads * buckets);
+        bool histograms_current = true;
+
+        for(size_t d = 0; d < digits; ++d) {
+            const size_t* total = totals.data() + d * buckets;
+            if(total[key::digit(key::of(src[0]), d)] == n) {
+                continue;
+            }
+
+            if(histograms_current) {
+                for(size_t t = 0; t < threads; ++t) {
+                    std::copy_n(local.data() + (t * digits + d) * buckets, buckets, chunk_hist.data() + t * buckets);
+                }
+            }
+            else if(threads > 1) {
+                std::fill(chunk_hist.begin(), chunk_hist.end(), 0);
+                detail::run_on_threads(threads, [&](size_t t) {
+                    const auto [lo, hi] = detail::thread_chunk(n, threads, t);
+                    size_t* hist        = chunk_hist.data() + t * buckets;
+                    for(size_t i = lo; i < hi; ++i) { ++hist[key::digit(key::of(src[i]), d)]; }
+                });
+            }
+            else {
+                std::copy_n(total, buckets, chunk_hist.data());
+            }
+
+            size_t running = 0;
+            for(size_t b = 0; b < buckets; ++b) {
+                for(size_t t = 0; t < threads; ++t) {
+                    offsets[t * buckets + b] = running;
+                    running += chunk_hist[t * buckets + b];
+                }
+            }
+
+            detail::run_on_threads(threads, [&](size_t t) {
+                const auto [lo, hi] = detail::thread_chunk(n, threads, t);
+                size_t* offset      = offsets.data() + t * buckets;
+                for(size_t i = lo; i < hi; ++i) { dst[offset[key::digit(key::of(src[i]), d)]++] = src[i]; }
+            });
+
+            std::swap(src, dst);
+            histograms_current = false;
+        }
+
+        if(src != first) {
+            detail::run_on_threads(threads, [&](size_t t) {
+                const auto [lo, hi] = detail::thread_chunk(n, threads, t);
+                std::copy(src + lo, src + hi, first + lo);
+            });
+        }
+    }
+}
+
+#endif
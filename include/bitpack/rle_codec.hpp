@@ -0,0 +1,309 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_RLE_CODEC_HPP
+#define BITPACK_RLE_CODEC_HPP
+
+#include <algorithm>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <bitpack/for_codec.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief A run length encoded column of unsigned integers.
+     *
+     * Each run is stored as a value and a length, both bit packed: values at the width of the bitpack field they came
+     * from (or the widest value), lengths at the width of the longest run. The row where every 64th run starts is kept as
+     * a sampled index, so finding the run holding a row takes a binary search and a short walk. Predicates and
+     * aggregates work on whole runs without expanding them.
+     *
+     * @tparam T The unsigned integer type of the values
+     */
+    template<typename T = std::uint64_t>
+    class rle_column {
+        static_assert(std::is_unsigned_v<T>, "rle_column only supports unsigned integers");
+
+    public:
+        rle_column() = default;
+
+        /**
+         * @brief Encodes n values
+         *
+         * @param values The values
+         * @param n The number of values
+         */
+        rle_column(const T* values, size_t n) {
+            _split(values, n);
+            T widest = 0;
+            for(const T value : _run_values) { widest = std::max(widest, value); }
+            _pack(detail::bit_width(widest));
+        }
+
+        /**
+         * @brief Encodes a contiguous range of values
+         *
+         */
+        template<typename R, typename = std::enable_if_t<!std::is_same_v<std::decay_t<R>, rle_column>>>
+        explicit rle_column(const R& values) : rle_column(std::data(values), std::size(values)) {}
+
+        /**
+         * @brief Encodes field I of a contiguous range of bitpacks, packing run values at the width of the field
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param records The bitpacks
+         * @return rle_column The encoded column
+         */
+        template<auto I, typename R>
+        static rle_column from_field(const R& records) {
+            using pack_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(records))>>;
+            constexpr size_t width = pack_type::layout_type::field_sizes[detail::index_to_sizet<I>()];
+            static_assert(width <= std::numeric_limits<T>::digits, "The field is wider than the column's value type");
+            std::vector<T> values(std::size(records));
+            const auto* in = std::data(records);
+            for(size_t i = 0; i < values.size(); ++i) { values[i] = static_cast<T>(in[i].template get<I>()); }
+            rle_column column;
+            column._split(values.data(), values.size());
+            column._pack(width);
+            return column;
+        }
+
+        /**
+         * @brief Decodes the column into field I of a contiguous range of bitpacks, which must have room for size() values
+         *
+         */
+        template<auto I, typename R>
+        void decode_field(R&& records) const {
+            assert(std::size(records) >= _size && "The bitpack range is shorter than the column");
+            auto* out = std::data(records);
+            for_each_run([&](T value, size_t start, size_t length) {
+                for(size_t i = start; i < start + length; ++i) { out[i].template set<I>(value); }
+            });
+        }
+
+        /**
+         * @brief Gets the number of values in the column
+         *
+         */
+        size_t size() const noexcept { return _size; }
+
+        /**
+         * @brief Gets the number of runs
+         *
+         */
+        size_t run_count() const noexcept { return _runs; }
+
+        /**
+         * @brief Gets the widths in bits that run values and run lengths are packed at
+         *
+         */
+        size_t value_width() const noexcept { return _value_width; }
+        size_t length_width() const noexcept { return _length_width; }
+
+        /**
+         * @brief Gets the value of run r
+         *
+         */
+        T run_value(size_t r) const noexcept { return static_cast<T>(detail::read_packed(_values.data(), _value_width, r)); }
+
+        /**
+         * @brief Gets the number of rows in run r
+         *
+         */
+        size_t run_length(size_t r) const noexcept {
+            return static_cast<size_t>(detail::read_packed(_lengths.data(), _length_width, r)) + 1;
+        }
+
+        /**
+         * @brief Gets the first row of run r
+         *
+         */
+        size_t run_start(size_t r) const noexcept {
+            size_t start = _samples[r / sample_rate];
+            for(size_t s = r - r % sample_rate; s < r; ++s) { start += run_length(s); }
+            return start;
+        }
+
+        /**
+         * @brief Finds the run holding a row
+         *
+         * @param row The row, less than size()
+         * @return size_t The index of the run
+         */
+        size_t find_run(size_t row) const noexcept {
+            assert(row < _size && "Row out of range");
+            const auto sample = std::upper_bound(_samples.begin(), _samples.end(), row) - _samples.begin() - 1;
+            size_t r          = static_cast<size_t>(sample) * sample_rate;
+            for(size_t start = _samples[static_cast<size_t>(sample)];; ++r) {
+                start += run_length(r);
+                if(row < start) {
+                    return r;
+                }
+            }
+        }
+
+        /**
+         * @brief Gets the value at a row
+         *
+         */
+        T operator[](size_t row) const noexcept { return run_value(find_run(row)); }
+
+        /**
+         * @brief Calls fn(value, start, length) for every run in order
+         *
+         */
+        template<typename F>
+        void for_each_run(F&& fn) const {
+            size_t start = 0;
+            for(size_t r = 0; r < _runs; ++r) {
+                const size_t length = run_length(r);
+                fn(run_value(r), start, length);
+                start += length;
+            }
+        }
+
+        /**
+         * @brief Decodes the column into out, which must have room for size() values
+         *
+         */
+        void decode(T* out) const {
+            for_each_run([&](T value, size_t start, size_t length) { std::fill(out + start, out + start + length, value); });
+        }
+
+        /**
+         * @brief Calls fn(start, length) for every run whose value lies within [lo, hi]
+         *
+         */
+        template<typename F>
+        void scan(T lo, T hi, F&& fn) const {
+            for_each_run([&](T value, size_t start, size_t length) {
+                if(value >= lo && value <= hi) {
+                    fn(start, length);
+                }
+            });
+        }
+
+        /**
+         * @brief Counts the rows whose value lies within [lo, hi]
+         *
+         */
+        size_t count(T lo, T hi) const {
+            size_t rows = 0;
+            scan(lo, hi, [&](size_t, size_t length) { rows += length; });
+            return rows;
+        }
+
+        /**
+         * @brief Sums the values of every row, wrapping on overflow
+         *
+         */
+        T sum() const {
+            T total = 0;
+            for_each_run([&](T value, size_t, size_t length) { total += static_cast<T>(value * static_cast<T>(length)); });
+            return total;
+        }
+
+        /**
+         * @brief Gets the smallest and largest value. The column must not be empty.
+         *
+         */
+        T min() const {
+            assert(_runs > 0 && "Empty column has no minimum");
+            T lowest = std::numeric_limits<T>::max();
+            for(size_t r = 0; r < _runs; ++r) { lowest = std::min(lowest, run_value(r)); }
+            return lowest;
+        }
+
+        T max() const {
+            assert(_runs > 0 && "Empty column has no maximum");
+            T highest = 0;
+            for(size_t r = 0; r < _runs; ++r) { highest = std::max(highest, run_value(r)); }
+            return highest;
+        }
+
+        /**
+         * @brief Gets the number of bytes used by the encoded runs and their index
+         *
+         */
+        size_t size_in_bytes() const noexcept {
+            return (_values.size() + _lengths.size()) * sizeof(std::uint64_t) + _samples.size() * sizeof(size_t);
+        }
+
+    private:
+        static constexpr size_t sample_rate = 64;
+
+        size_t _size         = 0;
+        size_t _runs         = 0;
+        size_t _value_width  = 0;
+        size_t _length_width = 0;
+        std::vector<std::uint64_t> _values;
+        std::vector<std::uint64_t> _lengths;
+        // The first row of every sample_rate-th run
+        std::vector<size_t> _samples;
+        // Runs before packing, only alive during construction
+        std::vector<T> _run_values;
+        std::vector<size_t> _run_lengths;
+
+        // Splits values into runs, leaving them to be packed by _pack
+        void _split(const T* values, size_t n) {
+            _size = n;
+            for(size_t i = 0; i < n;) {
+                size_t j = i + 1;
+                while(j < n && values[j] == values[i]) { ++j; }
+                _run_values.push_back(values[i]);
+                _run_lengths.push_back(j - i);
+                i = j;
+            }
+            _runs = _run_values.size();
+        }
+
+        void _pack(size_t value_width) {
+            size_t longest = 1;
+            for(const size_t length : _run_lengths) { longest = std::max(longest, length); }
+            _value_width  = value_width;
+            _length_width = detail::bit_width(longest - 1);
+            _values.assign((_runs * _value_width + 63) / 64, 0);
+            _lengths.assign((_runs * _length_width + 63) / 64, 0);
+            size_t start = 0;
+            for(size_t r = 0; r < _runs; ++r) {
+                if(r % sample_rate == 0) {
+                    _samples.push_back(start);
+                }
+                detail::write_packed(_values.data(), _value_width, r, _run_values[r]);
+                detail::write_packed(_lengths.data(), _length_width, r, _run_lengths[r] - 1);
+                start += _run_lengths[r];
+            }
+            _run_values  = {};
+            _run_lengths = {};
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,289 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_SPARSE_BITPACK_HPP
+#define BITPACK_SPARSE_BITPACK_HPP
+
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace bitpack {
+    namespace detail {
+        /*
+
+            A sparse bitpack stores a presence mask in its lowest N bits (bit I set when field I is present), followed
+            by only the present fields, packed upwards in field order. Field I therefore starts at N plus the widths of
+            the present fields below it. Fields are grouped by width, so that sum is one masked popcount per distinct
+            width, and a record with every field present takes the fixed offsets of the dense layout instead.
+
+            Storage is sized by a payload capacity rather than by the layout, so a record type whose fields rarely
+            appear together can be far smaller than the dense layout, which doesn't have to fit in 64 bits at all.
+
+        */
+
+        template<typename L>
+        struct sparse_offsets {
+            static constexpr size_t fields = L::field_sizes.size();
+
+            // Bits needed when every field is present
+            static constexpr size_t total = accumulate(L::field_sizes.begin(), L::field_sizes.end(), size_t(0));
+
+            // Offsets when every field is present
+            static constexpr std::array<size_t, fields> dense = [] {
+                std::array<size_t, fields> offsets {};
+                size_t offset = fields;
+                for(size_t i = 0; i < fields; ++i) {
+                    offsets[i] = offset;
+                    offset += L::field_sizes[i];
+                }
+                return offsets;
+            }();
+
+            struct width_group {
+                size_t width;
+                std::uint64_t fields;
+            };
+
+            static constexpr size_t group_count = [] {
+                size_t count = 0;
+                for(size_t i = 0; i < fields; ++i) {
+                    bool seen = false;
+                    for(size_t j = 0; j < i; ++j) { seen = seen || L::field_sizes[j] == L::field_sizes[i]; }
+                    count += seen ? 0 : 1;
+                }
+                return count;
+            }();
+
+            static constexpr std::array<width_group, group_count> groups = [] {
+                std::array<width_group, group_count> result {};
+                size_t count = 0;
+                for(size_t i = 0; i < fields; ++i) {
+                    size_t g = 0;
+                    while(g < count && result[g].width != L::field_sizes[i]) { ++g; }
+                    if(g == count) {
+                        result[count++].width = L::field_sizes[i];
+                    }
+                    result[g].fields |= std::uint64_t(1) << i;
+                }
+                return result;
+            }();
+
+            // The offset of field I under a presence mask
+            template<size_t I>
+            static constexpr size_t of(std::uint64_t mask) noexcept {
+                constexpr std::uint64_t full = low_mask(fields);
+                if(mask == full) {
+                    return dense[I];
+                }
+                const std::uint64_t below = mask & low_mask(I);
+                size_t offset             = fields;
+                for(size_t g = 0; g < group_count; ++g) { offset += groups[g].width * popcount(below & groups[g].fields); }
+                return offset;
+            }
+        };
+    }
+
+    /**
+     * @brief A bitpack that only spends bits on the fields that are present.
+     *
+     * The lowest bits hold one presence bit per field of L, and the present fields follow in field order, so a record
+     * with few fields present can be written to a bit stream in size_in_bits() bits. Absent fields read as zero.
+     *
+     * Only CAPACITY bits are reserved for the present fields, so storage is sized for the fields a record actually
+     * carries instead of every field of L. Setting a field that would take the present fields past CAPACITY bits is a
+     * precondition violation; fits() checks a presence mask ahead of time.
+     *
+     * @tparam L The layout listing every field that may be present
+     * @tparam CAPACITY The number of bits reserved for present fields. This defaults to every field of L
+     * @tparam D The storage detector
+     */
+    template<typename L,
+             size_t CAPACITY                                  = detail::sparse_offsets<L>::total,
+             template<storage_preference, size_t> typename D = layout_storage_detector>
+    class sparse_bitpack {
+        using offsets = detail::sparse_offsets<L>;
+
+        static constexpr size_t field_count = L::field_sizes.size();
+        static_assert(field_count <= 64, "A sparse bitpack supports up to 64 fields");
+
+    public:
+        /**
+         * @brief The layout of the fields
+         *
+         */
+        using layout_type = L;
+
+        /**
+         * @brief The number of bits reserved for present fields
+         *
+         */
+        static constexpr size_t capacity = CAPACITY;
+
+        /**
+         * @brief The type used to store the presence mask and the present fields
+         *
+         */
+        using storage_type = typename D<L::storage_preference, field_count + CAPACITY>::type;
+
+        static_assert(sizeof(storage_type) * CHAR_BIT >= field_count + CAPACITY,
+                      "The storage type is not able to store the presence mask and the payload capacity");
+
+    private:
+        storage_type _data = 0;
+
+        template<auto I>
+        using storage_at =
+            typename layout_storage_detector<L::storage_preference, L::field_sizes[detail::index_to_sizet<I>()]>::type;
+
+        static constexpr storage_type _low(size_t bits) noexcept { return static_cast<storage_type>(detail::low_mask(bits)); }
+
+    public:
+        /**
+         * @brief Constructs a sparse bitpack with no fields present
+         *
+         */
+        constexpr sparse_bitpack() noexcept = default;
+
+        /**
+         * @brief Constructs a sparse bitpack directly from its raw storage. Bits above size_in_bits() are expected to be
+         * zero.
+         *
+         */
+        explicit constexpr sparse_bitpack(storage_type data) noexcept : _data(data) { }
+
+        /**
+         * @brief Gets the raw storage
+         *
+         */
+        constexpr storage_type data() const noexcept { return _data; }
+
+        /**
+         * @brief Gets the presence mask, with bit I set when field I is present
+         *
+         */
+        constexpr std::uint64_t mask() const noexcept { return static_cast<std::uint64_t>(_data & _low(field_count)); }
+
+        /**
+         * @brief Gets the number of bits used by the presence mask and the present fields
+         *
+         */
+        constexpr size_t size_in_bits() const noexcept { return size_in_bits(mask()); }
+
+        /**
+         * @brief Gets the number of bits a sparse bitpack with a presence mask uses, such as when reading the rest of a
+         * record from a bit stream after its mask
+         *
+         */
+        static constexpr size_t size_in_bits(std::uint64_t mask) noexcept {
+            size_t bits = field_count;
+            for(const auto& group : offsets::groups) { bits += group.width * detail::popcount(mask & group.fields); }
+            return bits;
+        }
+
+        /**
+         * @brief Checks whether the fields of a presence mask fit in the payload capacity
+         *
+         */
+        static constexpr bool fits(std::uint64_t mask) noexcept { return size_in_bits(mask) <= field_count + CAPACITY; }
+
+        friend constexpr bool operator==(const sparse_bitpack& lhs, const sparse_bitpack& rhs) noexcept {
+            return lhs._data == rhs._data;
+        }
+        friend constexpr bool operator!=(const sparse_bitpack& lhs, const sparse_bitpack& rhs) noexcept {
+            return lhs._data != rhs._data;
+        }
+
+        /**
+         * @brief Checks whether field I is present
+         *
+         */
+        template<auto I>
+        constexpr bool has() const noexcept {
+            return (_data >> detail::index_to_sizet<I>()) & 1;
+        }
+
+        /**
+         * @brief Gets the value of field I, or zero if it isn't present
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @tparam R The return type. This defaults to what is detected by the bitpack's detector
+         */
+        template<auto I, typename R = storage_at<I>>
+        constexpr R get() const noexcept {
+            constexpr size_t index        = detail::index_to_sizet<I>();
+            constexpr auto unshifted_mask = bitmask_v<storage_type, L::field_sizes[index]>;
+            const size_t shift            = offsets::template of<index>(mask());
+            return has<I>() ? static_cast<R>((_data >> shift) & unshifted_mask) : R(0);
+        }
+
+        /**
+         * @brief Sets the value of field I, making it present and moving the fields above it up if it wasn't. Making a
+         * field present must keep the present fields within the payload capacity.
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param value The value of the field
+         */
+        template<auto I>
+        constexpr void set(storage_at<I> value) noexcept {
+            constexpr size_t index        = detail::index_to_sizet<I>();
+            constexpr size_t width        = L::field_sizes[index];
+            constexpr auto unshifted_mask = bitmask_v<storage_type, width>;
+            assert((value & unshifted_mask) == value &&
+                   "The input value overflows the bitwidth associated with the provided index");
+            const size_t shift = offsets::template of<index>(mask());
+            if(!has<I>()) {
+                assert(fits(mask() | (std::uint64_t(1) << index)) && "The present fields exceed the payload capacity");
+                const storage_type low = _data & _low(shift);
+                _data                  = low | static_cast<storage_type>((_data & ~_low(shift)) << width);
+                _data |= storage_type(1) << index;
+            }
+            _data &= ~static_cast<storage_type>(unshifted_mask << shift);
+            _data |= static_cast<storage_type>((value & unshifted_mask) << shift);
+        }
+
+        /**
+         * @brief Removes field I, moving the fields above it down
+         *
+         * @tparam I The index (numeric or enum) of the field
+         */
+        template<auto I>
+        constexpr void reset() noexcept {
+            constexpr size_t index = detail::index_to_sizet<I>();
+            constexpr size_t width = L::field_sizes[index];
+            if(has<I>()) {
+                const size_t shift     = offsets::template of<index>(mask());
+                const storage_type low = _data & _low(shift);
+                _data                  = low | static_cast<storage_type>(((_data >> shift) >> width) << shift);
+                _data &= ~(storage_type(1) << index);
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,256 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_SPLIT_PACKED_ARRAY_HPP
+#define BITPACK_SPLIT_PACKED_ARRAY_HPP
+
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    namespace detail {
+        /*
+
+            split_packed_array stores the hot fields of a layout as a dense array of bitpacks and the remaining cold
+            fields in a parallel array of 64 bit word groups. The cold fields are packed back to back and may straddle two
+            words, so the layout as a whole may be wider than the 64 bits a single bitpack can hold.
+
+        */
+
+        template<typename L, size_t H>
+        struct split_plan {
+            static constexpr size_t fields = L::field_sizes.size();
+
+            // Whether each field is hot, and its index among the hot fields or bit offset among the cold fields
+            std::array<bool, fields> hot {};
+            std::array<size_t, fields> slot {};
+            size_t cold_bits = 0;
+            bool valid       = true;
+
+            constexpr explicit split_plan(const std::array<size_t, H>& hot_fields) {
+                for(size_t h = 0; h < H; ++h) {
+                    if(hot_fields[h] >= fields || hot[hot_fields[h]]) {
+                        valid = false;
+                        continue;
+                    }
+                    hot[hot_fields[h]]  = true;
+                    slot[hot_fields[h]] = h;
+                }
+                for(size_t i = 0; i < fields; ++i) {
+                    if(!hot[i]) {
+                        slot[i] = cold_bits;
+                        cold_bits += L::field_sizes[i];
+                    }
+                }
+            }
+        };
+
+        template<typename L, size_t... HOT>
+        using hot_layout_t = layout<L::storage_preference, bitwidth<L::field_sizes[HOT]>...>;
+    }
+
+    /**
+     * @brief An array of records of layout L, with the hot fields stored apart from the cold ones so that scans over hot
+     * fields only touch the hot array.
+     *
+     * Rows are accessed through a proxy whose get<I> and set<I> go to the hot or the cold half, chosen at compile time.
+     * Only the hot fields need to fit in one bitpack; L itself may be wider than 64 bits.
+     *
+     * @tparam L The layout of a whole record
+     * @tparam HOT_FIELDS The indices (numeric or enum) of the hot fields
+     */
+    template<typename L, auto... HOT_FIELDS>
+    class split_packed_array {
+        static constexpr std::array<size_t, sizeof...(HOT_FIELDS)> hot_indices = { detail::index_to_sizet<HOT_FIELDS>()... };
+        static constexpr detail::split_plan<L, sizeof...(HOT_FIELDS)> plan { hot_indices };
+        static_assert(plan.valid, "Hot fields must be distinct indices of the layout's fields");
+
+    public:
+        /**
+         * @brief The layout of the hot fields, in the order they are listed
+         *
+         */
+        using hot_layout = detail::hot_layout_t<L, detail::index_to_sizet<HOT_FIELDS>()...>;
+
+        /**
+         * @brief The type of the dense array of hot fields
+         *
+         */
+        using hot_type = bitpack<hot_layout>;
+
+        /**
+         * @brief The number of 64 bit words holding the cold fields of each record
+         *
+         */
+        static constexpr size_t cold_words = (plan.cold_bits + 63) / 64;
+
+        /**
+         * @brief The cold fields of one record
+         *
+         */
+        using cold_type = std::array<std::uint64_t, cold_words>;
+
+        template<auto I>
+        using storage_at =
+            typename layout_storage_detector<L::storage_preference, L::field_sizes[detail::index_to_sizet<I>()]>::type;
+
+        /**
+         * @brief Proxy for one row of the array
+         *
+         */
+        template<bool CONST>
+        class basic_reference {
+            using owner_type = std::conditional_t<CONST, const split_packed_array, split_packed_array>;
+            owner_type* _owner;
+            size_t _row;
+
+        public:
+            basic_reference(owner_type& owner, size_t row) noexcept : _owner(&owner), _row(row) { }
+
+            template<auto I>
+            storage_at<I> get() const noexcept {
+                return _owner->template get<I>(_row);
+            }
+
+            template<auto I, bool C = CONST, typename = std::enable_if_t<!C>>
+            void set(storage_at<I> value) const noexcept {
+                _owner->template set<I>(_row, value);
+            }
+        };
+
+        using reference       = basic_reference<false>;
+        using const_reference = basic_reference<true>;
+
+        split_packed_array() = default;
+
+        /**
+         * @brief Creates an array of n records with every field set to zero
+         *
+         */
+        explicit split_packed_array(size_t n) : _hot(n), _cold(n) { }
+
+        size_t size() const noexcept { return _hot.size(); }
+        bool empty() const noexcept { return _hot.empty(); }
+
+        void resize(size_t n) {
+            _hot.resize(n);
+            _cold.resize(n);
+        }
+
+        reference operator[](size_t row) noexcept { return reference(*this, row); }
+        const_reference operator[](size_t row) const noexcept { return const_reference(*this, row); }
+
+        /**
+         * @brief Gets field I of a row
+         *
+         * @tparam I The index (numeric or enum) of the field in L
+         * @param row The row
+         */
+        template<auto I>
+        storage_at<I> get(size_t row) const noexcept {
+            constexpr size_t index = detail::index_to_sizet<I>();
+            assert(row < size() && "Row out of range");
+            if constexpr(plan.hot[index]) {
+                return static_cast<storage_at<I>>(_hot[row].template get<plan.slot[index]>());
+            }
+            else {
+                constexpr size_t width  = L::field_sizes[index];
+                constexpr size_t word   = plan.slot[index] / 64;
+                constexpr size_t offset = plan.slot[index] % 64;
+                const cold_type& words  = _cold[row];
+                std::uint64_t value     = words[word] >> offset;
+                if constexpr(offset + width > 64) {
+                    value |= words[word + 1] << (64 - offset);
+                }
+                return static_cast<storage_at<I>>(value & bitmask_v<std::uint64_t, width>);
+            }
+        }
+
+        /**
+         * @brief Sets field I of a row
+         *
+         * @tparam I The index (numeric or enum) of the field in L
+         * @param row The row
+         * @param value The value of the field
+         */
+        template<auto I>
+        void set(size_t row, storage_at<I> value) noexcept {
+            constexpr size_t index = detail::index_to_sizet<I>();
+            assert(row < size() && "Row out of range");
+            if constexpr(plan.hot[index]) {
+                _hot[row].template set<plan.slot[index]>(value);
+            }
+            else {
+                constexpr size_t width       = L::field_sizes[index];
+                constexpr size_t word        = plan.slot[index] / 64;
+                constexpr size_t offset      = plan.slot[index] % 64;
+                constexpr std::uint64_t mask = bitmask_v<std::uint64_t, width>;
+                const std::uint64_t bits     = static_cast<std::uint64_t>(value);
+                assert((bits & mask) == bits && "The input value overflows the bitwidth associated with the provided index");
+                cold_type& words = _cold[row];
+                words[word]      = (words[word] & ~(mask << offset)) | ((bits & mask) << offset);
+                if constexpr(offset + width > 64) {
+                    constexpr size_t spill = 64 - offset;
+                    words[word + 1]        = (words[word + 1] & ~(mask >> spill)) | ((bits & mask) >> spill);
+                }
+            }
+        }
+
+        /**
+         * @brief Gets the dense array of hot fields
+         *
+         */
+        const hot_type* hot_data() const noexcept { return _hot.data(); }
+        hot_type* hot_data() noexcept { return _hot.data(); }
+
+        /**
+         * @brief Gets the array of cold fields
+         *
+         */
+        const cold_type* cold_data() const noexcept { return _cold.data(); }
+
+        /**
+         * @brief Gets the number of bytes in the hot array, which is the working set of scans over hot fields
+         *
+         */
+        size_t hot_bytes() const noexcept { return _hot.size() * sizeof(hot_type); }
+
+        /**
+         * @brief Gets the number of bytes in the cold array
+         *
+         */
+        size_t cold_bytes() const noexcept { return _cold.size() * sizeof(cold_type); }
+
+    private:
+        std::vector<hot_type> _hot;
+        std::vector<cold_type> _cold;
+    };
+}
+
+#endif
@@ -0,0 +1,227 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_THREAD_POOL_HPP
+#define BITPACK_THREAD_POOL_HPP
+
+#include <atomic>
+#include <bitpack/detail/threads.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief A fixed size pool of threads that runs parallel loops with work stealing.
+     *
+     * A loop is split into chunks that are handed out to the threads in contiguous blocks. A thread works through its own
+     * block from the back and, once it runs dry, steals chunks from the front of the other blocks. The thread calling
+     * parallel_for takes part in the loop, so a pool of size 1 runs everything on the caller. A parallel_for called from
+     * inside a chunk of a loop on the same pool runs inline on the calling thread, since only one loop runs at a time.
+     */
+    class work_stealing_pool {
+    public:
+        /**
+         * @brief Constructs a pool
+         *
+         * @param threads The total number of threads, including the caller. 0 uses one thread per hardware thread.
+         */
+        explicit work_stealing_pool(size_t threads = 0) {
+            threads = detail::resolve_thread_count(threads, SIZE_MAX);
+            for(size_t i = 0; i < threads; ++i) {
+                _queues.push_back(std::make_unique<queue>());
+            }
+            for(size_t i = 1; i < threads; ++i) {
+                _workers.emplace_back([this, i]() { _worker_loop(i); });
+            }
+        }
+
+        work_stealing_pool(const work_stealing_pool&)            = delete;
+        work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+        ~work_stealing_pool() {
+            {
+                std::lock_guard<std::mutex> lock(_wake_mutex);
+                _stop = true;
+            }
+            _wake.notify_all();
+            for(auto& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        /**
+         * @brief Gets the total number of threads used by parallel loops, including the caller
+         *
+         * @return size_t The number of threads
+         */
+        size_t size() const noexcept { return _queues.size(); }
+
+        /**
+         * @brief Runs fn(first, last) over [0, n) split into chunks of grain items, and waits for every chunk to finish.
+         * Which thread runs a chunk is not deterministic, but the chunk boundaries are. fn must not throw.
+         *
+         * @param n The number of items
+         * @param grain The number of items per chunk
+         * @param fn The function to run on each chunk
+         */
+        template<typename F>
+        void parallel_for(size_t n, size_t grain, F&& fn) {
+            if(n == 0) {
+                return;
+            }
+            grain               = grain == 0 ? 1 : grain;
+            const size_t chunks = (n + grain - 1) / grain;
+            if(size() == 1 || chunks == 1 || _current() == this) {
+                for(size_t c = 0; c < chunks; ++c) {
+                    fn(c * grain, c + 1 == chunks ? n : (c + 1) * grain);
+                }
+                return;
+            }
+
+            // Only one loop runs on the pool at a time
+            std::lock_guard<std::mutex> job_lock(_job_mutex);
+            _job_fn = [](void* ctx, size_t first, size_t last) {
+                (*static_cast<std::remove_reference_t<F>*>(ctx))(first, last);
+            };
+            _job_ctx   = &fn;
+            _job_n     = n;
+            _job_grain = grain;
+            _remaining.store(chunks, std::memory_order_relaxed);
+
+            for(size_t q = 0; q < size(); ++q) {
+                const auto [lo, hi] = detail::thread_chunk(chunks, size(), q);
+                std::lock_guard<std::mutex> lock(_queues[q]->mutex);
+                for(size_t c = lo; c < hi; ++c) {
+                    _queues[q]->chunks.push_back(c);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_wake_mutex);
+                ++_generation;
+            }
+            _wake.notify_all();
+
+            while(_remaining.load(std::memory_order_acquire) != 0) {
+                if(!_try_run(0)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+    private:
+        /**
+         * @brief The chunks assigned to one thread
+         *
+         */
+        struct queue {
+            std::mutex mutex;
+            std::deque<size_t> chunks;
+        };
+
+        std::vector<std::unique_ptr<queue>> _queues;
+        std::vector<std::thread> _workers;
+
+        std::mutex _job_mutex;
+        void (*_job_fn)(void*, size_t, size_t) = nullptr;
+        void* _job_ctx                         = nullptr;
+        size_t _job_n                          = 0;
+        size_t _job_grain                      = 1;
+        std::atomic<size_t> _remaining { 0 };
+
+        std::mutex _wake_mutex;
+        std::condition_variable _wake;
+        std::uint64_t _generation = 0;
+        bool _stop                = false;
+
+        // The pool whose chunk the calling thread is running, if any
+        static const work_stealing_pool*& _current() noexcept {
+            thread_local const work_stealing_pool* pool = nullptr;
+            return pool;
+        }
+
+        /**
+         * @brief Takes a chunk from the thread's own queue, or steals one from another queue, and runs it
+         *
+         * @param self The index of the calling thread
+         * @return true If a chunk was run
+         */
+        bool _try_run(size_t self) {
+            size_t chunk = 0;
+            bool found   = false;
+            {
+                std::lock_guard<std::mutex> lock(_queues[self]->mutex);
+                if(!_queues[self]->chunks.empty()) {
+                    chunk = _queues[self]->chunks.back();
+                    _queues[self]->chunks.pop_back();
+                    found = true;
+                }
+            }
+            for(size_t i = 1; !found && i < size(); ++i) {
+                queue& victim = *_queues[(self + i) % size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if(!victim.chunks.empty()) {
+                    chunk = victim.chunks.front();
+                    victim.chunks.pop_front();
+                    found = true;
+                }
+            }
+            if(!found) {
+                return false;
+            }
+
+            const size_t first = chunk * _job_grain;
+            const size_t last  = first + _job_grain < _job_n ? first + _job_grain : _job_n;
+            const work_stealing_pool* outer = _current();
+            _current()                      = this;
+            _job_fn(_job_ctx, first, last);
+            _current() = outer;
+            _remaining.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+
+        void _worker_loop(size_t self) {
+            std::uint64_t seen = 0;
+            while(true) {
+                {
+                    std::unique_lock<std::mutex> lock(_wake_mutex);
+                    _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+                    if(_stop) {
+                        return;
+                    }
+                    seen = _generation;
+                }
+                while(_try_run(self)) { }
+            }
+        }
+    };
+}
+
+#endif
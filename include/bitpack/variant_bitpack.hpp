@@ -0,0 +1,287 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_VARIANT_BITPACK_HPP
+#define BITPACK_VARIANT_BITPACK_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <exception>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bitpack {
+    /**
+     * @brief Layout type for a tagged union of layouts. The tag takes the lowest TAG_WIDTH bits and the fields of the
+     * active alternative follow it, placed as in that alternative's own layout.
+     *
+     * @tparam TAG_WIDTH The width in bits of the tag
+     * @tparam LAYOUTS The layout of each alternative. The storage preference is taken from the first one.
+     */
+    template<size_t TAG_WIDTH, typename... LAYOUTS>
+    struct variant_layout {
+        static_assert(sizeof...(LAYOUTS) > 0, "A variant layout needs at least one alternative");
+        static_assert(TAG_WIDTH < 64 && sizeof...(LAYOUTS) <= (size_t(1) << TAG_WIDTH),
+                      "The tag is not wide enough to tell every alternative apart");
+
+        /**
+         * @brief The width in bits of the tag
+         *
+         */
+        static constexpr size_t tag_width = TAG_WIDTH;
+
+        /**
+         * @brief The number of alternatives
+         *
+         */
+        static constexpr size_t alternative_count = sizeof...(LAYOUTS);
+
+        /**
+         * @brief The layout of alternative A
+         *
+         */
+        template<size_t A>
+        using alternative = std::tuple_element_t<A, std::tuple<LAYOUTS...>>;
+
+        /**
+         * @brief The storage preference (fast or small)
+         *
+         */
+        static constexpr ::bitpack::storage_preference storage_preference = alternative<0>::storage_preference;
+
+        /**
+         * @brief The number of bits needed by the tag and the widest alternative. An alternative spans up to the end of its
+         * highest field, which is past its total bitwidth if it leaves gaps between fields.
+         *
+         */
+        static constexpr size_t total_bitwidth =
+            TAG_WIDTH + std::max({ detail::field_extent(LAYOUTS::field_sizes, LAYOUTS::field_offsets)... });
+    };
+
+    /**
+     * @brief A bitpack holding one of several layouts, told apart by a tag.
+     *
+     * get<A, I> and set<A, I> use the same compile time shift and mask as a flat bitpack, offset by the tag width, and
+     * visit() dispatches through a table indexed by the tag.
+     *
+     * @tparam VL A variant_layout
+     * @tparam D The storage detector
+     */
+    template<typename VL, template<storage_preference, size_t> typename D = layout_storage_detector>
+    class variant_bitpack {
+    public:
+        /**
+         * @brief The variant layout of the bitpack
+         *
+         */
+        using layout_type = VL;
+
+        /**
+         * @brief The type used to store the tag and the fields of any alternative
+         *
+         */
+        using storage_type = typename D<VL::storage_preference, VL::total_bitwidth>::type;
+
+        static_assert(sizeof(storage_type) * CHAR_BIT >= VL::total_bitwidth, "The storage type is not able to store enough bits");
+
+        /**
+         * @brief A flat bitpack of alternative A
+         *
+         */
+        template<size_t A>
+        using alternative_type = bitpack<typename VL::template alternative<A>, D>;
+
+    private:
+        storage_type _data = 0;
+
+        static constexpr storage_type tag_mask = bitmask_v<storage_type, VL::tag_width>;
+
+        template<size_t A, auto I>
+        using storage_at = typename layout_storage_detector<
+            VL::template alternative<A>::storage_preference,
+            VL::template alternative<A>::field_sizes[detail::index_to_sizet<I>()]>::type;
+
+        template<size_t A, typename F>
+        static constexpr decltype(auto) _visit_alternative(F& fn, storage_type data) {
+            return fn(_unpack<A>(data));
+        }
+
+        template<size_t A>
+        static constexpr alternative_type<A> _unpack(storage_type data) noexcept {
+            using alternative                 = typename VL::template alternative<A>;
+            using alternative_storage         = typename alternative_type<A>::storage_type;
+            constexpr size_t width            = detail::field_extent(alternative::field_sizes, alternative::field_offsets);
+            constexpr storage_type field_mask = bitmask_v<storage_type, width>;
+            return alternative_type<A>(static_cast<alternative_storage>((data >> VL::tag_width) & field_mask));
+        }
+
+        template<typename F, size_t... As>
+        constexpr decltype(auto) _visit(F& fn, std::index_sequence<As...>) const {
+            using result_type = decltype(fn(std::declval<alternative_type<0>>()));
+            using visitor     = result_type (*)(F&, storage_type);
+            constexpr std::array<visitor, sizeof...(As)> table = { &_visit_alternative<As, F>... };
+            // The tag can hold values past the last alternative, which only a corrupted or foreign storage word has
+            if(!valid()) {
+                std::terminate();
+            }
+            return table[index()](fn, _data);
+        }
+
+    public:
+        /**
+         * @brief Constructs a variant holding alternative 0 with every field set to zero
+         *
+         */
+        constexpr variant_bitpack() noexcept = default;
+
+        /**
+         * @brief Constructs a variant holding alternative A with the fields of a flat bitpack
+         *
+         */
+        template<size_t A>
+        static constexpr variant_bitpack make(const alternative_type<A>& value) noexcept {
+            static_assert(A < VL::alternative_count, "Alternative index out of range");
+            return variant_bitpack(static_cast<storage_type>(A | (storage_type(value.data()) << VL::tag_width)));
+        }
+
+        /**
+         * @brief Constructs a variant directly from its raw storage
+         *
+         */
+        explicit constexpr variant_bitpack(storage_type data) noexcept : _data(data) { }
+
+        /**
+         * @brief Gets the raw storage
+         *
+         */
+        constexpr storage_type data() const noexcept { return _data; }
+
+        /**
+         * @brief Gets the index of the active alternative
+         *
+         */
+        constexpr size_t index() const noexcept { return static_cast<size_t>(_data & tag_mask); }
+
+        /**
+         * @brief Checks whether the tag names an alternative, which is always the case unless the variant was constructed
+         * from raw storage
+         *
+         */
+        constexpr bool valid() const noexcept { return index() < VL::alternative_count; }
+
+        /**
+         * @brief Checks whether alternative A is active
+         *
+         */
+        template<size_t A>
+        constexpr bool holds() const noexcept {
+            return index() == A;
+        }
+
+        /**
+         * @brief Makes alternative A active with every field set to zero
+         *
+         */
+        template<size_t A>
+        constexpr void emplace() noexcept {
+            static_assert(A < VL::alternative_count, "Alternative index out of range");
+            _data = static_cast<storage_type>(A);
+        }
+
+        /**
+         * @brief Gets the active alternative as a flat bitpack
+         *
+         */
+        template<size_t A>
+        constexpr alternative_type<A> as() const noexcept {
+            assert(holds<A>() && "Alternative is not active");
+            return _unpack<A>(_data);
+        }
+
+        /**
+         * @brief Gets field I of alternative A, which must be active
+         *
+         * @tparam A The index of the alternative
+         * @tparam I The index (numeric or enum) of the field within the alternative
+         * @tparam R The return type. This defaults to what is detected by the bitpack's detector
+         */
+        template<size_t A, auto I, typename R = storage_at<A, I>>
+        constexpr R get() const noexcept {
+            using alternative             = typename VL::template alternative<A>;
+            constexpr size_t index        = detail::index_to_sizet<I>();
+            constexpr auto unshifted_mask = bitmask_v<storage_type, alternative::field_sizes[index]>;
+            constexpr size_t shift        = VL::tag_width + alternative::field_offsets[index];
+            constexpr storage_type mask   = unshifted_mask << shift;
+            assert(holds<A>() && "Alternative is not active");
+            return (_data & mask) >> shift;
+        }
+
+        /**
+         * @brief Sets field I of alternative A, which must be active
+         *
+         * @tparam A The index of the alternative
+         * @tparam I The index (numeric or enum) of the field within the alternative
+         * @param value The value of the field
+         */
+        template<size_t A, auto I>
+        constexpr void set(storage_at<A, I> value) noexcept {
+            using alternative             = typename VL::template alternative<A>;
+            constexpr size_t index        = detail::index_to_sizet<I>();
+            constexpr auto unshifted_mask = bitmask_v<storage_type, alternative::field_sizes[index]>;
+            constexpr size_t shift        = VL::tag_width + alternative::field_offsets[index];
+            constexpr storage_type mask   = unshifted_mask << shift;
+            assert(holds<A>() && "Alternative is not active");
+            assert((value & unshifted_mask) == value &&
+                   "The input value overflows the bitwidth associated with the provided index");
+            _data &= ~mask;
+            _data |= (value & unshifted_mask) << shift;
+        }
+
+        /**
+         * @brief Calls fn with the active alternative as a flat bitpack. fn must return the same type for every
+         * alternative. A tag that doesn't name an alternative (see valid()) calls std::terminate.
+         *
+         * @param fn The visitor
+         * @return decltype(auto) What fn returns
+         */
+        template<typename F>
+        constexpr decltype(auto) visit(F&& fn) const {
+            assert(valid() && "Tag does not name an alternative");
+            return _visit(fn, std::make_index_sequence<VL::alternative_count>());
+        }
+
+        friend constexpr bool operator==(const variant_bitpack& lhs, const variant_bitpack& rhs) noexcept {
+            return lhs._data == rhs._data;
+        }
+        friend constexpr bool operator!=(const variant_bitpack& lhs, const variant_bitpack& rhs) noexcept {
+            return lhs._data != rhs._data;
+        }
+    };
+}
+
+#endif
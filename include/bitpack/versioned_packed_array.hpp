@@ -0,0 +1,290 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_VERSIONED_PACKED_ARRAY_HPP
+#define BITPACK_VERSIONED_PACKED_ARRAY_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/convert.hpp>
+#include <bitpack/layout_fingerprint.hpp>
+#include <bitpack/mmap_packed_array.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+    /**
+     * @brief When records stored with an older layout are upgraded to the current one
+     *
+     */
+    enum class upgrade_mode {
+        // Each block of records is upgraded the first time one of its records is read
+        LAZY,
+        // Every record is upgraded when the file is opened
+        ON_LOAD
+    };
+
+    /**
+     * @brief A read-only packed record file whose records may have been written with any layout of a layout_history.
+     *
+     * Opening compares the file's schema fingerprint with the fingerprint of each layout in the history. Files written
+     * with the current layout are mapped and read in place, like mmap_packed_array. Files written with an older layout are
+     * mapped too, and their records are converted to the current layout (see convert) a block at a time, either lazily or
+     * all at once. Fields are matched by tag, so tag the fields of every layout in the history. Values that don't fit a
+     * narrowed field are truncated.
+     *
+     * Lazy upgrades write to the array from const reads, so call upgrade_all() before sharing a lazily upgraded array
+     * between threads.
+     *
+     * @tparam H A layout_history
+     * @tparam D The storage detector
+     */
+    template<typename H, template<storage_preference, size_t> typename D = layout_storage_detector>
+    class versioned_packed_array {
+    public:
+        /**
+         * @brief The current layout
+         *
+         */
+        using layout_type = typename H::current;
+
+        /**
+         * @brief The type of the records
+         *
+         */
+        using value_type = bitpack<layout_type, D>;
+
+        /**
+         * @brief The number of records converted together by a lazy upgrade
+         *
+         */
+        static constexpr size_t upgrade_block = 4096;
+
+        versioned_packed_array() = default;
+
+        versioned_packed_array(const versioned_packed_array&)            = delete;
+        versioned_packed_array& operator=(const versioned_packed_array&) = delete;
+
+        versioned_packed_array(versioned_packed_array&& other) noexcept { *this = std::move(other); }
+
+        versioned_packed_array& operator=(versioned_packed_array&& other) noexcept {
+            if(this != &other) {
+                close();
+                _mapping  = std::exchange(other._mapping, nullptr);
+                _length   = std::exchange(other._length, 0);
+                _stored   = std::exchange(other._stored, nullptr);
+                _records  = std::exchange(other._records, nullptr);
+                _size     = std::exchange(other._size, 0);
+                _version  = std::exchange(other._version, 0);
+                _open     = std::exchange(other._open, false);
+                _lazy     = std::exchange(other._lazy, false);
+                _upgraded = std::move(other._upgraded);
+                _ready    = std::move(other._ready);
+            }
+            return *this;
+        }
+
+        ~versioned_packed_array() { close(); }
+
+        /**
+         * @brief Maps a packed record file written with any layout of the history
+         *
+         * @param path The path of the file
+         * @param mode When records of an older layout are upgraded
+         * @return packed_file_status OK on success, SCHEMA_MISMATCH if no layout of the history matches the file
+         */
+        packed_file_status open(const char* path, upgrade_mode mode = upgrade_mode::LAZY) {
+            close();
+            void* mapping = nullptr;
+            size_t length = 0;
+            auto status   = detail::map_packed_file(path, false, mapping, length);
+            if(status != packed_file_status::OK) {
+                return status;
+            }
+
+            size_t offset     = 0;
+            size_t count      = 0;
+            size_t version    = 0;
+            const auto* bytes = static_cast<const std::uint8_t*>(mapping);
+            status            = _check(bytes, length, offset, count, version, std::make_index_sequence<H::version_count>());
+            if(status != packed_file_status::OK) {
+                ::munmap(mapping, length);
+                return status;
+            }
+
+            _mapping = mapping;
+            _length  = length;
+            _stored  = bytes + offset;
+            _size    = count;
+            _version = version;
+            _open    = true;
+            if(version == 0) {
+                _records = reinterpret_cast<const value_type*>(_stored);
+                return packed_file_status::OK;
+            }
+            _upgraded.resize(count);
+            _ready.assign((count + upgrade_block - 1) / upgrade_block, 0);
+            _records = _upgraded.data();
+            _lazy    = true;
+            if(mode == upgrade_mode::ON_LOAD) {
+                upgrade_all();
+            }
+            return packed_file_status::OK;
+        }
+
+        /**
+         * @brief Upgrades every record that hasn't been upgraded yet and unmaps the file, which is no longer needed
+         *
+         */
+        void upgrade_all() noexcept {
+            if(!_lazy) {
+                return;
+            }
+            for(size_t block = 0; block < _ready.size(); ++block) {
+                if(!_ready[block]) {
+                    _upgrade_block(block);
+                }
+            }
+            ::munmap(_mapping, _length);
+            _mapping = nullptr;
+            _length  = 0;
+            _stored  = nullptr;
+            _lazy    = false;
+        }
+
+        /**
+         * @brief Unmaps the file and releases any upgraded records
+         *
+         */
+        void close() noexcept {
+            if(_mapping != nullptr) {
+                ::munmap(_mapping, _length);
+            }
+            _mapping = nullptr;
+            _length  = 0;
+            _stored  = nullptr;
+            _records = nullptr;
+            _size    = 0;
+            _version = 0;
+            _open    = false;
+            _lazy    = false;
+            _upgraded.clear();
+            _ready.clear();
+        }
+
+        bool is_open() const noexcept { return _open; }
+        size_t size() const noexcept { return _size; }
+        bool empty() const noexcept { return _size == 0; }
+
+        /**
+         * @brief Gets the version of the layout the file was written with, 0 for the current layout and k for the k-th
+         * older layout of the history
+         *
+         */
+        size_t version() const noexcept { return _version; }
+
+        /**
+         * @brief Checks if some records are still stored with an older layout and will be upgraded when read
+         *
+         */
+        bool upgrade_pending() const noexcept { return _lazy; }
+
+        const value_type& operator[](size_t idx) const noexcept {
+            assert(idx < _size && "versioned_packed_array index out of range");
+            if(_lazy && !_ready[idx / upgrade_block]) {
+                _upgrade_block(idx / upgrade_block);
+            }
+            return _records[idx];
+        }
+
+        /**
+         * @brief Gets field I of record idx, upgrading the record's block first if needed
+         *
+         * @tparam I The index (numeric or enum) of the field
+         * @param idx The index of the record
+         */
+        template<auto I>
+        auto get(size_t idx) const noexcept {
+            return (*this)[idx].template get<I>();
+        }
+
+    private:
+        using upgrader = void (*)(const std::uint8_t*, size_t, size_t, value_type*);
+
+        template<size_t V>
+        static void _upgrade(const std::uint8_t* stored, size_t first, size_t n, value_type* out) noexcept {
+            using stored_type = bitpack<typename H::template version<V>, D>;
+            static_assert(sizeof(stored_type) == sizeof(typename stored_type::storage_type),
+                          "bitpacks must be stored as their raw storage to be memory mapped");
+            convert(reinterpret_cast<const stored_type*>(stored) + first, n, out + first);
+        }
+
+        template<size_t... Vs>
+        static packed_file_status _check(const std::uint8_t* bytes,
+                                         size_t length,
+                                         size_t& offset,
+                                         size_t& count,
+                                         size_t& version,
+                                         std::index_sequence<Vs...>) noexcept {
+            // Each try is one fingerprint compare, stopping at the first layout that isn't a mismatch
+            auto status            = packed_file_status::SCHEMA_MISMATCH;
+            const auto try_version = [&](auto v) {
+                using stored_type = bitpack<typename H::template version<decltype(v)::value>, D>;
+                status  = detail::check_packed_file_header<stored_type>(bytes, length, offset, count);
+                version = decltype(v)::value;
+                return status != packed_file_status::SCHEMA_MISMATCH;
+            };
+            (try_version(std::integral_constant<size_t, Vs>()) || ...);
+            return status;
+        }
+
+        template<size_t... Vs>
+        static constexpr std::array<upgrader, sizeof...(Vs)> _upgraders(std::index_sequence<Vs...>) noexcept {
+            return { &_upgrade<Vs>... };
+        }
+
+        void _upgrade_block(size_t block) const noexcept {
+            constexpr auto table = _upgraders(std::make_index_sequence<H::version_count>());
+            const size_t first   = block * upgrade_block;
+            table[_version](_stored, first, std::min(upgrade_block, _size - first), _upgraded.data());
+            _ready[block] = 1;
+        }
+
+        void* _mapping                            = nullptr;
+        size_t _length                            = 0;
+        const std::uint8_t* _stored               = nullptr;
+        const value_type* _records                = nullptr;
+        size_t _size                              = 0;
+        size_t _version                           = 0;
+        bool _open                                = false;
+        bool _lazy                                = false;
+        mutable std::vector<value_type> _upgraded = {};
+        mutable std::vector<std::uint8_t> _ready  = {};
+    };
+}
+
+#endif
@@ -0,0 +1,173 @@
+/*
+MIT License
+
+Copyright (c) 2023 Kieran Hsieh
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BITPACK_WIDTH_FIT_HPP
+#define BITPACK_WIDTH_FIT_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/convert.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace bitpack {
+    /**
+     * @brief Gets the smallest width that holds every value of a column, and at least 1
+     *
+     * @param values The values
+     * @param n The number of values
+     * @param step Only look at every step-th value, to fit from a sample. Must be at least 1
+     */
+    template<typename T>
+    constexpr size_t fit_width(const T* values, size_t n, size_t step = 1) noexcept {
+        static_assert(std::is_unsigned_v<T>, "fit_width only supports unsigned integers");
+        assert(step > 0 && "The sampling step must be at least 1");
+        T seen = 0;
+        for(size_t i = 0; i < n; i += step) { seen |= values[i]; }
+        return std::max<size_t>(1, detail::bit_width(static_cast<std::uint64_t>(seen)));
+    }
+
+    namespace detail {
+        template<typename P, size_t... Is>
+        void fit_field_widths(const P* records, size_t n, size_t step, std::array<size_t, sizeof...(Is)>& widths,
+                              std::index_sequence<Is...>) noexcept {
+            assert(step > 0 && "The sampling step must be at least 1");
+            // OR-ing is enough to find the highest set bit of each field, and keeps the loop free of compares
+            std::array<std::uint64_t, sizeof...(Is)> seen {};
+            for(size_t i = 0; i < n; i += step) {
+                ((seen[Is] |= static_cast<std::uint64_t>(records[i].template get<Is>())), ...);
+            }
+            ((widths[Is] = std::max<size_t>(1, bit_width(seen[Is]))), ...);
+        }
+    }
+
+    /**
+     * @brief Gets the smallest width that holds every observed value of each field of a range of bitpacks
+     *
+     * @param records A contiguous range of bitpacks
+     * @param step Only look at every step-th record, to fit from a sample. Must be at least 1
+     * @return std::array<size_t, N> The width of each field, at least 1
+     */
+    template<typename R>
+    auto fit_field_widths(const R& records, size_t step = 1) noexcept {
+        using pack_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(records))>>;
+        constexpr size_t fields = pack_type::layout_type::field_sizes.size();
+        std::array<size_t, fields> widths {};
+        detail::fit_field_widths(std::data(records), std::size(records), step, widths, std::make_index_sequence<fields>());
+        return widths;
+    }
+
+    /**
+     * @brief The text of a layout type, built without allocating so that it can be a compile time constant
+     *
+     * @tparam N The number of fields
+     */
+    template<size_t N>
+    class layout_type_text {
+    public:
+        /**
+         * @brief The most characters the text can take, with every width at its longest
+         *
+         */
+        static constexpr size_t capacity = 52 + N * (20 + std::numeric_limits<size_t>::digits10 + 1 + 1) + 1;
+
+        constexpr void append(std::string_view text) noexcept {
+            for(const char c : text) { _chars[_length++] = c; }
+        }
+
+        constexpr void append(size_t value) noexcept {
+            char digits[std::numeric_limits<size_t>::digits10 + 1] {};
+            size_t count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while(value != 0);
+            while(count > 0) { _chars[_length++] = digits[--count]; }
+        }
+
+        constexpr std::string_view view() const noexcept { return std::string_view(_chars.data(), _length); }
+
+        std::string str() const { return std::string(view()); }
+
+        friend constexpr bool operator==(const layout_type_text& lhs, std::string_view rhs) noexcept {
+            return lhs.view() == rhs;
+        }
+        friend constexpr bool operator!=(const layout_type_text& lhs, std::string_view rhs) noexcept {
+            return lhs.view() != rhs;
+        }
+
+    private:
+        std::array<char, capacity> _chars {};
+        size_t _length = 0;
+    };
+
+    /**
+     * @brief Spells out a layout type with the given field widths, to paste into code. With constant widths, such as ones
+     * fitted at compile time by fit_width, the text is a compile time constant.
+     *
+     * @param widths The width of each field
+     * @param p The storage preference of the layout
+     * @return layout_type_text<N> For example "bitpack::layout<bitpack::storage_preference::SMALL, bitpack::bitwidth<3>>"
+     */
+    template<size_t N>
+    constexpr layout_type_text<N> layout_type_string(const std::array<size_t, N>& widths,
+                                                     storage_preference p = storage_preference::FAST) noexcept {
+        layout_type_text<N> type;
+        type.append("bitpack::layout<bitpack::storage_preference::");
+        type.append(p == storage_preference::FAST ? "FAST" : "SMALL");
+        for(const size_t width : widths) {
+            type.append(", bitpack::bitwidth<");
+            type.append(width);
+            type.append(">");
+        }
+        type.append(">");
+        return type;
+    }
+
+    /**
+     * @brief Copies every field of n bitpacks of layout LO into bitpacks of layout LN with the same number of fields,
+     * as by the bulk convert. Tagged fields are copied from the field with the same tag, wherever it is, and untagged
+     * fields from the untagged field at the same index.
+     *
+     * @param in The bitpacks to convert
+     * @param n The number of bitpacks
+     * @param out The converted bitpacks, which must have room for n
+     * @return bool false if some value didn't fit its new width and was truncated
+     */
+    template<typename LN, typename LO, template<storage_preference, size_t> typename D, overflow_policy O>
+    bool repack(const bitpack<LO, D, O>* in, size_t n, bitpack<LN, D, O>* out) noexcept {
+        static_assert(LO::field_sizes.size() == LN::field_sizes.size(), "repack needs layouts with the same number of fields");
+        return convert<LN>(in, n, out);
+    }
+}
+
+#endif
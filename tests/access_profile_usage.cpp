@@ -0,0 +1,74 @@
+#define BITPACK_PROFILE_ACCESS
+#include <bitpack/bitpack.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using hot_layout  = bitpack::small_layout<bitpack::bitwidth<4>, bitpack::bitwidth<12>, bitpack::bitwidth<16>>;
+using cold_layout = bitpack::fast_layout<bitpack::bitwidth<1>>;
+
+constexpr bitpack::bitpack<hot_layout> make_constant() {
+    bitpack::bitpack<hot_layout> b;
+    b.set<1>(100);
+    return b;
+}
+
+int main() {
+    bitpack::report_access_profile_at_exit(false);
+
+    // Test that bitpacks are still usable in constant expressions, where nothing is counted
+    constexpr auto constant = make_constant();
+    static_assert(constant.get<1>() == 100);
+
+    // Test that calls are counted per field and per layout, across threads
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            bitpack::bitpack<hot_layout> b;
+            for(std::uint32_t i = 0; i < 1000; ++i) {
+                b.set<2>(i);
+                assert(b.get<2>() == i);
+            }
+            assert(b.get<0>() == 0);
+        });
+    }
+    bitpack::bitpack<cold_layout> cold;
+    cold.set<0>(1);
+    for(auto& thread : threads) { thread.join(); }
+
+    const std::vector<bitpack::field_access_counts> profile = bitpack::access_profile();
+    assert(profile.size() == 2);
+    for(const auto& layout : profile) {
+        if(layout.gets.size() == 3) {
+            assert(layout.layout.find("bitwidth<12>") != std::string::npos);
+            assert(layout.sets[2] == 4000 && layout.gets[2] == 4000 && layout.gets[0] == 4);
+            assert(layout.gets[1] == 0 && layout.sets[1] == 0 && layout.total() == 8004);
+        }
+        else {
+            assert(layout.sets[0] == 1 && layout.total() == 1);
+        }
+    }
+
+    // Test that the report lists the hottest layout and field first
+    std::ostringstream report;
+    bitpack::write_access_profile(report);
+    const std::string text = report.str();
+    assert(text.find("8004 accesses") < text.find("1 accesses"));
+    assert(text.find("field 2: 4000 gets, 4000 sets") < text.find("field 0: 4 gets"));
+    assert(text.find("field 1:") == std::string::npos || text.find("field 1: 0 gets") != std::string::npos);
+
+    // Test resetting the counts
+    bitpack::reset_access_profile();
+    for([[maybe_unused]] const auto& layout : bitpack::access_profile()) { assert(layout.total() == 0); }
+    assert(cold.get<0>() == 1);
+    assert(bitpack::access_profile()[1].gets[0] + bitpack::access_profile()[0].gets[0] == 1);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <bitpack/bit_stream.hpp>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/optimized_layout.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+int main() {
+    using header_layout = bitpack::small_layout<bitpack::bitwidth<3>, bitpack::bitwidth<10>>;
+    using header        = bitpack::bitpack<header_layout>;
+
+    // Values of every width from 0 to 64, written back to back
+    std::mt19937_64 rng(9);
+    std::vector<std::pair<std::uint64_t, size_t>> fields;
+    for(size_t i = 0; i < 20000; ++i) {
+        const size_t width = i % 65;
+        fields.emplace_back(rng() & bitpack::detail::low_mask(width), width);
+    }
+
+    // Test that variable width fields round trip through a vector
+    std::vector<std::uint8_t> bytes;
+    size_t total_bits = 0;
+    {
+        bitpack::bit_writer writer(bitpack::vector_sink { bytes });
+        for(const auto& [value, width] : fields) {
+            writer.write(value, width);
+            total_bits += width;
+        }
+        [[maybe_unused]] const bool flushed = writer.flush();
+        assert(flushed);
+        assert(writer.bits_written() == (total_bits + 7) / 8 * 8);
+    }
+    assert(bytes.size() == (total_bits + 7) / 8);
+
+    bitpack::bit_reader reader(bitpack::buffer_source { bytes.data(), bytes.size() });
+    for(const auto& field : fields) {
+        [[maybe_unused]] const std::uint64_t value = reader.read(field.second);
+        assert(value == field.first);
+    }
+    assert(reader.good());
+    reader.read(16);
+    assert(!reader.good());
+
+    // Test that fixed width fields and whole bitpacks round trip, including across a flush
+    header h {};
+    h.set<0>(5);
+    h.set<1>(1000);
+    std::vector<std::uint8_t> record_bytes;
+    {
+        bitpack::bit_writer writer(bitpack::vector_sink { record_bytes });
+        writer.write<1>(1);
+        writer.write(h);
+        writer.write<40>(0xABCDE12345);
+        writer.flush();
+        writer.write(h);
+    }
+    assert(record_bytes.size() == 9);
+    bitpack::bit_reader record_reader(bitpack::buffer_source { record_bytes.data(), record_bytes.size() });
+    assert(record_reader.read<1>() == 1);
+    assert(record_reader.read<header>() == h);
+    assert(record_reader.read<40>() == 0xABCDE12345);
+    record_reader.align();
+    assert(record_reader.read<header>() == h);
+
+    // Test writing a bitpack with a non-default overflow policy
+    using checked_header = bitpack::bitpack<header_layout, bitpack::layout_storage_detector, bitpack::overflow_policy::CHECKED>;
+    checked_header c {};
+    c.set<1>(700);
+    std::vector<std::uint8_t> checked_bytes;
+    {
+        bitpack::bit_writer writer(bitpack::vector_sink { checked_bytes });
+        writer.write(c);
+    }
+    bitpack::bit_reader checked_reader(bitpack::buffer_source { checked_bytes.data(), checked_bytes.size() });
+    assert(checked_bytes.size() == 2 && checked_reader.read<checked_header>() == c);
+
+    // Test that a layout with a gap between its fields round trips every field, including the one above the gap
+    using gapped_layout = bitpack::optimized_layout<bitpack::layout_hints<bitpack::storage_preference::SMALL, 0, 1>,
+                                                    bitpack::bitwidth<4>,
+                                                    bitpack::bitwidth<6>,
+                                                    bitpack::bitwidth<3>>;
+    using gapped        = bitpack::bitpack<gapped_layout>;
+    static_assert(bitpack::layout_traits<gapped_layout>::total_bitwidth == 13 && gapped_layout::field_offsets[1] == 10);
+    gapped g {};
+    g.set<0>(5);
+    g.set<1>(33);
+    g.set<2>(6);
+    std::vector<std::uint8_t> gapped_bytes;
+    {
+        bitpack::bit_writer writer(bitpack::vector_sink { gapped_bytes });
+        writer.write(g);
+        writer.write<3>(7);
+    }
+    bitpack::bit_reader gapped_reader(bitpack::buffer_source { gapped_bytes.data(), gapped_bytes.size() });
+    [[maybe_unused]] const gapped read_back = gapped_reader.read<gapped>();
+    assert(read_back == g && read_back.get<1>() == 33 && gapped_reader.read<3>() == 7);
+
+    // Test that a file stream larger than the internal buffer round trips
+    std::FILE* file = std::tmpfile();
+    assert(file != nullptr);
+    {
+        bitpack::bit_writer writer(bitpack::file_sink { file });
+        for(size_t i = 0; i < 100000; ++i) { writer.write(i, 17); }
+    }
+    std::rewind(file);
+    bitpack::bit_reader file_reader(bitpack::file_source { file });
+    for(size_t i = 0; i < 100000; ++i) { assert(file_reader.read(17) == (i & 0x1FFFF)); }
+    assert(file_reader.good());
+    std::fclose(file);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -66,6 +66,104 @@ int main() {
     assert(bitpack.get<PacketIdx::Header>() == 1);
     assert(bitpack.get<PacketIdx::Content>() == 8);
 
+    // Test that sortable layouts place field 0 at the most significant bits
+    using sort_layout = bitpack::small_sortable_layout<bitpack::bitwidth<4>, bitpack::bitwidth<8>, bitpack::bitwidth<4>>;
+    static_assert(sort_layout::field_offsets[0] == 12);
+    static_assert(sort_layout::field_offsets[1] == 4);
+    static_assert(sort_layout::field_offsets[2] == 0);
+    static_assert(pack_layout::field_offsets[1] == 8);
+
+    auto sorted_lo = bitpack::bitpack<sort_layout> {};
+    auto sorted_hi = bitpack::bitpack<sort_layout> {};
+    sorted_lo.set<0>(1);
+    sorted_lo.set<1>(255);
+    sorted_hi.set<0>(2);
+    assert(sorted_lo.get<1>() == 255);
+    assert(sorted_lo.data() == 0x1FF0);
+    assert(sorted_lo < sorted_hi);
+    assert(sorted_lo.to_sort_key() == sorted_lo.data());
+
+    // Test that the sort key of an LSB_FIRST layout orders fields lexicographically
+    auto unsorted_lo = bitpack::bitpack<pack_layout> {};
+    auto unsorted_hi = bitpack::bitpack<pack_layout> {};
+    unsorted_lo.set<0>(1);
+    unsorted_lo.set<1>(511);
+    unsorted_hi.set<0>(2);
+    assert(unsorted_lo.data() > unsorted_hi.data());
+    assert(unsorted_lo < unsorted_hi);
+    assert(unsorted_lo.to_sort_key() == ((1u << 9) | 511u));
+    assert(bitpack::bitpack<pack_layout>(unsorted_lo.data()) == unsorted_lo);
+
+    // Test that in place adds wrap within the field without touching its neighbours
+    using counter_layout = bitpack::small_layout<bitpack::bitwidth<4>, bitpack::bitwidth<6>, bitpack::bitwidth<6>>;
+    auto counters        = bitpack::bitpack<counter_layout> {};
+    counters.set<0>(15);
+    counters.set<1>(62);
+    counters.set<2>(63);
+    counters.increment<1>();
+    assert(counters.get<1>() == 63);
+    counters.increment<1>();
+    assert(counters.get<0>() == 15 && counters.get<1>() == 0 && counters.get<2>() == 63);
+    counters.add<0>(3);
+    assert(counters.get<0>() == 2 && counters.get<1>() == 0);
+    counters.add<2>(2);
+    assert(counters.get<2>() == 1 && counters.data() == 0x402);
+    static_assert([] {
+        auto packed = bitpack::bitpack<counter_layout> {};
+        packed.add<1>(70);
+        return packed.get<1>() == 6;
+    }());
+
+    // Test that saturating adds stop at the largest value of the field
+    counters.saturating_add<1>(40);
+    assert(counters.get<1>() == 40);
+    counters.saturating_add<1>(40);
+    assert(counters.get<1>() == 63 && counters.get<0>() == 2 && counters.get<2>() == 1);
+    counters.saturating_add<0>(0);
+    assert(counters.get<0>() == 2);
+    counters.saturating_add<2>(255);
+    assert(counters.get<2>() == 63 && counters.get<1>() == 63);
+
+    // Test each overflow policy
+    using policy = bitpack::overflow_policy;
+    static_assert(bitpack::bitpack<counter_layout>::overflow_policy == policy::ASSERT);
+
+    auto truncated = bitpack::bitpack<counter_layout, bitpack::layout_storage_detector, policy::TRUNCATE> {};
+    truncated.set<1>(70);
+    assert(truncated.get<1>() == 6 && truncated.get<0>() == 0 && truncated.get<2>() == 0);
+
+    auto saturated = bitpack::bitpack<counter_layout, bitpack::layout_storage_detector, policy::SATURATE> {};
+    saturated.set<1>(70);
+    assert(saturated.get<1>() == 63 && saturated.get<2>() == 0);
+    saturated.set<1>(5);
+    assert(saturated.get<1>() == 5);
+    saturated.set<0>(255);
+    assert(saturated.get<0>() == 15 && saturated.get<1>() == 5);
+
+    auto checked = bitpack::bitpack<counter_layout, bitpack::layout_storage_detector, policy::CHECKED> {};
+    [[maybe_unused]] bool stored = checked.set<1>(9);
+    assert(stored);
+    stored = checked.set<1>(64);
+    assert(!stored);
+    assert(checked.get<1>() == 9 && checked.get<0>() == 0 && checked.get<2>() == 0);
+    stored = checked.set<2>(63);
+    assert(stored && checked.get<2>() == 63);
+    static_assert([] {
+        auto packed = bitpack::bitpack<counter_layout, bitpack::layout_storage_detector, policy::CHECKED> {};
+        return packed.set<0>(15) && !packed.set<0>(16) && packed.get<0>() == 15;
+    }());
+
+    auto counted = bitpack::bitpack<counter_layout, bitpack::layout_storage_detector, policy::COUNT> {};
+    bitpack::reset_overflow_count();
+    counted.set<1>(63);
+    assert(bitpack::overflow_count() == 0);
+    counted.set<1>(64);
+    counted.set<2>(200);
+    assert(bitpack::overflow_count() == 2);
+    assert(counted.get<1>() == 0 && counted.get<2>() == (200 & 63));
+    bitpack::reset_overflow_count();
+    assert(bitpack::overflow_count() == 0);
+
     std::cout << "Tests passed!\n";
 
     return 0;
@@ -0,0 +1,92 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/bitvector.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    // Checks rank and select against a plain vector of bools
+    void check([[maybe_unused]] const bitpack::packed_bitvector& bits, const std::vector<bool>& expected) {
+        assert(bits.size() == expected.size());
+        size_t ones = 0;
+        for(size_t i = 0; i < expected.size(); ++i) {
+            assert(bits.rank1(i) == ones);
+            assert(bits.rank0(i) == i - ones);
+            if(expected[i]) {
+                assert(bits.select1(ones) == i);
+                ++ones;
+            }
+            else {
+                assert(bits.select0(i - ones) == i);
+            }
+            assert(bits[i] == expected[i]);
+        }
+        assert(bits.rank1(expected.size()) == ones && bits.count() == ones);
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(38);
+
+    // Test densities from sparse to full, with sizes that don't fill the last word or block
+    for(const unsigned percent : { 0u, 1u, 50u, 97u, 100u }) {
+        std::vector<bool> expected(300000 + percent);
+        bitpack::packed_bitvector bits;
+        for(size_t i = 0; i < expected.size(); ++i) {
+            expected[i] = rng() % 100 < percent;
+            bits.push_back(expected[i]);
+        }
+        bits.build();
+        check(bits, expected);
+    }
+
+    // Test construction from words and in place changes
+    {
+        const std::vector<std::uint64_t> words = { 0xF0F0F0F0F0F0F0F0ULL, ~std::uint64_t(0) };
+        bitpack::packed_bitvector bits(words.data(), 100);
+        assert(bits.count() == 32 + 36);
+        assert(bits.select1(0) == 4 && bits.select1(32) == 64 && bits.select0(0) == 0);
+        bits.set(0);
+        bits.set(64, false);
+        bits.build();
+        assert(bits.count() == 68 && bits.select1(0) == 0 && bits.rank1(66) == 33 + 1);
+
+        const bitpack::packed_bitvector ones(5000, true);
+        assert(ones.count() == 5000 && ones.select1(4999) == 4999 && ones.word_count() == 79);
+        assert((ones.data()[78] == bitpack::bitmask_v<std::uint64_t, 5000 % 64>));
+    }
+
+    // Test that the directory stays within a few percent of the bits
+    {
+        const bitpack::packed_bitvector bits(size_t(1) << 24, true);
+        [[maybe_unused]] const size_t payload = (size_t(1) << 24) / 8;
+        assert(bits.size_in_bytes() - payload < payload * 6 / 100);
+    }
+
+    // Test using the bitvector as the presence index of a sparse field
+    {
+        using record = bitpack::bitpack<bitpack::small_layout<bitpack::bitwidth<12>>>;
+        bitpack::packed_bitvector present;
+        std::vector<record> values;
+        std::vector<std::uint64_t> rows(10000);
+        for(size_t i = 0; i < rows.size(); ++i) {
+            rows[i] = i % 7 == 0 ? i % 4096 : 0;
+            present.push_back(rows[i] != 0);
+            if(rows[i] != 0) {
+                values.emplace_back().set<0>(rows[i]);
+            }
+        }
+        present.build();
+        for(size_t i = 0; i < rows.size(); ++i) {
+            [[maybe_unused]] const std::uint64_t value = present[i] ? values[present.rank1(i)].get<0>() : 0;
+            assert(value == rows[i]);
+        }
+    }
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
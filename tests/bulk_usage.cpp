@@ -0,0 +1,94 @@
+#include <atomic>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/bulk.hpp>
+#include <bitpack/thread_pool.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+int main() {
+    using row_layout = bitpack::fast_layout<bitpack::bitwidth<12>, bitpack::bitwidth<20>, bitpack::bitwidth<32>>;
+    using row        = bitpack::bitpack<row_layout>;
+
+    const size_t n = 500000;
+    std::vector<std::uint16_t> ids(n);
+    std::vector<std::uint32_t> regions(n);
+    std::vector<std::uint64_t> values(n);
+    for(size_t i = 0; i < n; ++i) {
+        ids[i]     = static_cast<std::uint16_t>(i % 4096);
+        regions[i] = static_cast<std::uint32_t>((i * 7) % (1 << 20));
+        values[i]  = (i * 2654435761u) & 0xFFFFFFFFu;
+    }
+
+    // Test that the serial bulk operations round trip
+    std::vector<row> rows(n);
+    bitpack::pack_columns(rows, ids, regions, values);
+    for(size_t i = 0; i < n; i += 997) {
+        assert(rows[i].get<0>() == ids[i]);
+        assert(rows[i].get<1>() == regions[i]);
+        assert(rows[i].get<2>() == values[i]);
+    }
+    std::vector<std::uint32_t> unpacked(n);
+    bitpack::unpack_column<1>(rows, unpacked);
+    assert(unpacked == regions);
+
+    // Test that the parallel bulk operations produce the same output as the serial ones
+    bitpack::work_stealing_pool pool(4);
+    assert(pool.size() == 4);
+    std::vector<row> parallel_rows(n);
+    bitpack::parallel_pack_columns(pool, parallel_rows, ids, regions, values);
+    assert(parallel_rows == rows);
+    std::vector<std::uint64_t> parallel_unpacked(n);
+    bitpack::parallel_unpack_column<2>(pool, parallel_rows, parallel_unpacked);
+    assert(parallel_unpacked == values);
+
+    // Test that every chunk of a parallel loop runs exactly once, across several loops on the same pool
+    for(size_t loop = 0; loop < 20; ++loop) {
+        std::vector<std::atomic<int>> visits(10007);
+        pool.parallel_for(visits.size(), 13, [&](size_t first, size_t last) {
+            for(size_t i = first; i < last; ++i) { ++visits[i]; }
+        });
+        for([[maybe_unused]] const auto& v : visits) { assert(v == 1); }
+    }
+
+    // Test that a loop started from inside a chunk of another loop on the same pool runs inline
+    {
+        std::vector<std::atomic<int>> visits(64 * 100);
+        pool.parallel_for(64, 1, [&](size_t first, size_t) {
+            pool.parallel_for(100, 7, [&](size_t inner_first, size_t inner_last) {
+                for(size_t i = inner_first; i < inner_last; ++i) { ++visits[first * 100 + i]; }
+            });
+        });
+        for([[maybe_unused]] const auto& v : visits) { assert(v == 1); }
+    }
+
+    // Test that workers are joined when the calling thread's share throws
+    {
+        std::atomic<int> finished { 0 };
+        [[maybe_unused]] bool caught = false;
+        try {
+            bitpack::detail::run_on_threads(4, [&](size_t t) {
+                if(t == 0) {
+                    throw 1;
+                }
+                ++finished;
+            });
+        }
+        catch(int) {
+            caught = true;
+        }
+        assert(caught && finished == 3);
+    }
+
+    // Test that a single threaded pool runs on the caller
+    bitpack::work_stealing_pool single(1);
+    size_t covered = 0;
+    single.parallel_for(100, 30, [&](size_t first, size_t last) { covered += last - first; });
+    assert(covered == 100);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
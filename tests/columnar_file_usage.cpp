@@ -0,0 +1,112 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/columnar_file.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() {
+    [[maybe_unused]] bitpack::packed_file_status status;
+    using record_layout = bitpack::fast_layout<bitpack::bitwidth<20>, bitpack::bitwidth<7>, bitpack::bitwidth<33>>;
+    using other_layout  = bitpack::fast_layout<bitpack::bitwidth<20>, bitpack::bitwidth<8>, bitpack::bitwidth<32>>;
+    using record        = bitpack::bitpack<record_layout>;
+
+    const std::string path = std::string(P_tmpdir) + "/bitpack_columnar_file_test.bin";
+
+    // Field 0 is sorted, so its zone maps are disjoint and range scans can skip most blocks
+    std::vector<record> records(1000);
+    for(size_t i = 0; i < records.size(); ++i) {
+        records[i].set<0>(i * 3);
+        records[i].set<1>(i % 100);
+        records[i].set<2>(i * 1000003);
+    }
+    status = bitpack::write_columnar_file<128>(path.c_str(), records);
+    assert(status == bitpack::packed_file_status::OK);
+
+    for(const auto access : { bitpack::columnar_access::MMAP, bitpack::columnar_access::PREAD }) {
+        bitpack::columnar_file<record_layout, 128> file;
+        status = file.open(path.c_str(), access);
+        assert(status == bitpack::packed_file_status::OK);
+        assert(file.size() == records.size());
+        assert(file.block_count() == 8);
+
+        // Test that rows are reassembled from their columns
+        for(size_t i = 0; i < records.size(); ++i) { assert(file.row(i) == records[i]); }
+
+        // Test that zone maps hold the range of each field in each block
+        assert(file.block_min<0>(0) == 0 && file.block_max<0>(0) == 127 * 3);
+        assert(file.block_min<0>(7) == 896 * 3 && file.block_max<0>(7) == 999 * 3);
+        assert(file.block_min<1>(2) == 0 && file.block_max<1>(2) == 99);
+
+        // Test that a selective scan only reads the blocks that can match
+        std::vector<size_t> rows;
+        const auto collect = [&](size_t row, [[maybe_unused]] std::uint64_t value) {
+            assert(value == row * 3);
+            rows.push_back(row);
+        };
+        [[maybe_unused]] const bitpack::scan_stats stats = file.scan<0>(600, 900, collect);
+        assert(rows.size() == 101 && rows.front() == 200 && rows.back() == 300);
+        assert(stats.blocks_scanned == 2 && stats.blocks_skipped == 6);
+        assert(stats.bytes_scanned == 2 * 128 * 20 / 8 && stats.bytes_skipped == 6 * 128 * 20 / 8);
+
+        // Test that a scan on a field without clustering visits every block and skips nothing
+        size_t matches                    = 0;
+        [[maybe_unused]] const bitpack::scan_stats unsorted = file.scan<1>(10, 19, [&](size_t, std::uint64_t) { ++matches; });
+        assert(matches == 100 && unsorted.blocks_skipped == 0);
+
+        // Test that a scan outside every zone map reads nothing
+        const auto never_called                          = [](size_t, std::uint64_t) { assert(false); };
+        [[maybe_unused]] const bitpack::scan_stats empty = file.scan<2>(std::uint64_t(1) << 32, ~std::uint64_t(0), never_called);
+        assert(empty.blocks_scanned == 0 && empty.bytes_scanned == 0);
+
+        // Test decoding a whole column block, including the zero padding past the last row
+        std::vector<std::uint64_t> values(128);
+        [[maybe_unused]] const bool decoded = file.decode_block<2>(7, values.data());
+        assert(decoded);
+        assert(values[0] == 896 * 1000003 && values[103] == 999 * 1000003 && values[104] == 0);
+    }
+
+    // Test that files are rejected for a different layout or block size
+    {
+        bitpack::columnar_file<other_layout, 128> mismatched;
+        status = mismatched.open(path.c_str());
+        assert(status == bitpack::packed_file_status::SCHEMA_MISMATCH);
+        bitpack::columnar_file<record_layout, 256> resized;
+        status = resized.open(path.c_str());
+        assert(status == bitpack::packed_file_status::SCHEMA_MISMATCH);
+    }
+
+    // Test that truncated and missing files fail to open
+    {
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        std::fseek(file, 0, SEEK_END);
+        const long full = std::ftell(file);
+        std::fclose(file);
+        [[maybe_unused]] const int truncated_file = ::truncate(path.c_str(), full - 8);
+        assert(truncated_file == 0);
+        bitpack::columnar_file<record_layout, 128> truncated;
+        status = truncated.open(path.c_str());
+        assert(status == bitpack::packed_file_status::TRUNCATED);
+        std::remove(path.c_str());
+        status = truncated.open(path.c_str());
+        assert(status == bitpack::packed_file_status::OPEN_FAILED);
+    }
+
+    // Test an empty file
+    {
+        status = bitpack::write_columnar_file(path.c_str(), std::vector<record>());
+        assert(status == bitpack::packed_file_status::OK);
+        bitpack::columnar_file<record_layout> empty;
+        status = empty.open(path.c_str());
+        assert(status == bitpack::packed_file_status::OK);
+        assert(empty.size() == 0 && empty.block_count() == 0);
+        std::remove(path.c_str());
+    }
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
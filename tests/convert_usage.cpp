@@ -0,0 +1,115 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/convert.hpp>
+#include <bitpack/optimized_layout.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+enum class fields {
+    ID,
+    AGE,
+    FLAGS,
+    SCORE
+};
+
+using bitpack::bitwidth;
+using bitpack::field_tag;
+
+using v1_layout = bitpack::fast_layout<bitwidth<20, field_tag<fields::ID>>,
+                                       bitwidth<7, field_tag<fields::AGE>>,
+                                       bitwidth<5, field_tag<fields::FLAGS>>>;
+// Adds a field at the front, widens ID and moves FLAGS before AGE
+using v2_layout = bitpack::fast_layout<bitwidth<10, field_tag<fields::SCORE>>,
+                                       bitwidth<24, field_tag<fields::ID>>,
+                                       bitwidth<5, field_tag<fields::FLAGS>>,
+                                       bitwidth<7, field_tag<fields::AGE>>>;
+using v1 = bitpack::bitpack<v1_layout>;
+using v2 = bitpack::bitpack<v2_layout>;
+
+int main() {
+    // Test field tags
+    static_assert(std::is_same_v<bitpack::layout_field_tag_t<v2_layout, 1>, field_tag<fields::ID>>);
+    static_assert(std::is_same_v<bitpack::layout_field_tag_t<bitpack::fast_layout<bitwidth<3>>, 0>, void>);
+    static_assert(v1_layout::field_sizes[0] == 20);
+
+    // Test converting a single bitpack, at compile time and at run time
+    constexpr v2 converted = [] {
+        v1 old;
+        old.set<fields::ID>(123456);
+        old.set<fields::AGE>(99);
+        old.set<fields::FLAGS>(0b10101);
+        return bitpack::convert<v2_layout>(old);
+    }();
+    static_assert(converted.get<0>() == 0);
+    static_assert(converted.get<1>() == 123456);
+    static_assert(converted.get<2>() == 0b10101);
+    static_assert(converted.get<3>() == 99);
+
+    // Every field moves by a different distance from v1 to v2, while appending a field moves none of them
+    using v1_appended = bitpack::fast_layout<bitwidth<20, field_tag<fields::ID>>,
+                                             bitwidth<7, field_tag<fields::AGE>>,
+                                             bitwidth<5, field_tag<fields::FLAGS>>,
+                                             bitwidth<10, field_tag<fields::SCORE>>>;
+    static_assert(bitpack::detail::convert_plan_v<v1_layout, v2_layout>.group_count == 3);
+    static_assert(bitpack::detail::convert_plan_v<v1_layout, v1_appended>.group_count == 1);
+    static_assert(bitpack::detail::convert_plan_v<v1_layout, v1_appended>.shifts[0] == 0);
+
+    // Test converting back, which narrows ID
+    [[maybe_unused]] const v1 back = bitpack::convert<v1_layout>(converted);
+    assert(back.get<fields::ID>() == 123456 && back.get<fields::AGE>() == 99 && back.get<fields::FLAGS>() == 0b10101);
+
+    // Test untagged fields, matched by index, and an inserted field that pushes a tagged one into an optimized layout
+    using plain    = bitpack::fast_layout<bitwidth<4>, bitwidth<8>, bitwidth<12, field_tag<fields::SCORE>>>;
+    using shuffled = bitpack::optimized_layout<bitpack::layout_hints<bitpack::storage_preference::FAST, 3>,
+                                               bitwidth<4>,
+                                               bitwidth<8>,
+                                               bitwidth<6>,
+                                               bitwidth<12, field_tag<fields::SCORE>>>;
+    bitpack::bitpack<plain> p;
+    p.set<0>(9);
+    p.set<1>(200);
+    p.set<2>(4000);
+    [[maybe_unused]] const auto q = bitpack::convert<shuffled>(p);
+    assert(q.get<0>() == 9 && q.get<1>() == 200 && q.get<2>() == 0 && q.get<3>() == 4000);
+
+    // Test the bulk conversion against field by field conversion
+    std::vector<v1> records(3000);
+    for(size_t i = 0; i < records.size(); ++i) {
+        records[i].set<fields::ID>(i * 311);
+        records[i].set<fields::AGE>(i % 128);
+        records[i].set<fields::FLAGS>(i % 32);
+    }
+    std::vector<v2> upgraded(records.size());
+    [[maybe_unused]] bool fits = bitpack::convert(records.data(), records.size(), upgraded.data());
+    assert(fits);
+    for(size_t i = 0; i < records.size(); ++i) { assert(upgraded[i] == bitpack::convert<v2_layout>(records[i])); }
+    assert(upgraded[2999].get<1>() == 2999 * 311 && upgraded[2999].get<3>() == 2999 % 128);
+
+    // Test that narrowing reports values that don't fit
+    std::vector<v1> downgraded(records.size());
+    fits = bitpack::convert(upgraded.data(), upgraded.size(), downgraded.data());
+    assert(fits && downgraded == records);
+    upgraded[7].set<1>(1 << 22);
+    fits = bitpack::convert(upgraded.data(), upgraded.size(), downgraded.data());
+    assert(!fits);
+    assert(downgraded[7].get<fields::ID>() == 0 && downgraded[7].get<fields::AGE>() == 7);
+
+    // Test that the overflow policy carries over, and that narrowing truncates without asserting under TRUNCATE
+    using policy = bitpack::overflow_policy;
+    bitpack::bitpack<v2_layout, bitpack::layout_storage_detector, policy::TRUNCATE> wide;
+    wide.set<1>((1 << 22) | 77);
+    wide.set<3>(3);
+    [[maybe_unused]] const auto narrow = bitpack::convert<v1_layout>(wide);
+    static_assert(decltype(narrow)::overflow_policy == policy::TRUNCATE);
+    assert(narrow.get<fields::ID>() == 77 && narrow.get<fields::AGE>() == 3);
+    std::vector<decltype(wide)> wide_records(4, wide);
+    std::vector<std::remove_const_t<decltype(narrow)>> narrow_records(4);
+    fits = bitpack::convert(wide_records.data(), wide_records.size(), narrow_records.data());
+    assert(!fits && narrow_records[3] == narrow);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/delta_codec.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main() {
+    // Test the prefix sum and zigzag helpers
+    std::vector<std::uint32_t> sums = { 1, 2, 3, 4, 5, 6, 7 };
+    bitpack::detail::prefix_sum(sums.data(), sums.size(), std::uint32_t(10));
+    assert((sums == std::vector<std::uint32_t> { 11, 13, 16, 20, 25, 31, 38 }));
+    std::vector<std::uint64_t> wide_sums = { 1, 2, 3 };
+    bitpack::detail::prefix_sum(wide_sums.data(), wide_sums.size(), std::uint64_t(0));
+    assert((wide_sums == std::vector<std::uint64_t> { 1, 3, 6 }));
+    static_assert(bitpack::detail::zigzag_encode(std::uint32_t(0)) == 0);
+    static_assert(bitpack::detail::zigzag_encode(std::uint32_t(-1)) == 1);
+    static_assert(bitpack::detail::zigzag_encode(std::uint32_t(1)) == 2);
+    static_assert(bitpack::detail::zigzag_decode(bitpack::detail::zigzag_encode(std::uint64_t(-12345))) == std::uint64_t(-12345));
+
+    std::mt19937_64 rng(5);
+
+    // Slowly rising sequence numbers
+    std::vector<std::uint64_t> sequence(1000);
+    std::uint64_t seq = 1ULL << 38;
+    for(auto& s : sequence) { s = seq += rng() % 4; }
+
+    // Test delta encoding round trips and packs each delta in a few bits
+    const bitpack::delta_column<std::uint64_t> deltas(sequence);
+    std::vector<std::uint64_t> decoded(sequence.size());
+    deltas.decode(decoded.data());
+    assert(decoded == sequence);
+    for(size_t b = 0; b < deltas.block_count(); ++b) { assert(deltas.block_width(b) <= 2); }
+    for(size_t i = 0; i < sequence.size(); i += 33) { assert(deltas[i] == sequence[i]); }
+
+    // Timestamps ticking at a steadily increasing rate
+    std::vector<std::uint32_t> timestamps(777);
+    std::uint32_t ts   = 1000000;
+    std::uint32_t rate = 1000;
+    for(auto& t : timestamps) { t = ts += rate++; }
+
+    // Test delta of delta encoding round trips and is narrower than plain deltas
+    const bitpack::delta_column<std::uint32_t, bitpack::delta_order::DELTA_OF_DELTA, 256> dod(timestamps);
+    const bitpack::delta_column<std::uint32_t, bitpack::delta_order::DELTA, 256> plain(timestamps);
+    std::vector<std::uint32_t> dod_decoded(timestamps.size());
+    dod.decode(dod_decoded.data());
+    assert(dod_decoded == timestamps);
+    assert(dod.block_width(0) == 0);
+    assert(plain.block_width(0) == 8);
+    assert(dod[500] == timestamps[500]);
+    assert(dod.size_in_bytes() < plain.size_in_bytes());
+
+    // Test that values that go down still round trip
+    std::vector<std::uint64_t> noisy(300);
+    for(auto& n : noisy) { n = rng(); }
+    const bitpack::delta_column<std::uint64_t, bitpack::delta_order::DELTA_OF_DELTA> noisy_column(noisy);
+    std::vector<std::uint64_t> noisy_decoded(noisy.size());
+    noisy_column.decode(noisy_decoded.data());
+    assert(noisy_decoded == noisy);
+
+    // Test encoding a field of a bitpack array and decoding it back
+    using log_layout = bitpack::fast_layout<bitpack::bitwidth<40>, bitpack::bitwidth<24>>;
+    std::vector<bitpack::bitpack<log_layout>> logs(400);
+    for(size_t i = 0; i < logs.size(); ++i) {
+        logs[i].set<0>(sequence[i]);
+        logs[i].set<1>(i);
+    }
+    const auto field = bitpack::delta_column<std::uint64_t>::from_field<0>(logs);
+    std::vector<bitpack::bitpack<log_layout>> restored(logs.size());
+    field.decode_field<0>(restored);
+    for(size_t i = 0; i < logs.size(); ++i) { assert(restored[i].get<0>() == logs[i].get<0>()); }
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
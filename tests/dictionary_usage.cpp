@@ -0,0 +1,91 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/dictionary.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+int main() {
+    // Test that codes are handed out densely in order of first appearance
+    {
+        bitpack::dictionary dict;
+        assert(dict.empty() && dict.code_width() == 0);
+        assert(dict.find(7) == bitpack::dictionary::npos);
+        [[maybe_unused]] const std::uint32_t first    = dict.encode(1000);
+        [[maybe_unused]] const std::uint32_t second   = dict.encode(0xFFFFFFFF);
+        [[maybe_unused]] const std::uint32_t repeated = dict.encode(1000);
+        [[maybe_unused]] const std::uint32_t third    = dict.encode(0);
+        assert(first == 0 && second == 1 && repeated == 0 && third == 2);
+        assert(dict.size() == 3 && dict.code_width() == 2);
+        assert(dict.find(0xFFFFFFFF) == 1 && dict.find(1) == bitpack::dictionary::npos);
+        assert(dict.decode(0) == 1000 && dict[1] == 0xFFFFFFFF && dict[2] == 0);
+    }
+
+    // Test that lookups survive many rehashes and colliding IDs
+    {
+        bitpack::dictionary dict;
+        for(std::uint32_t i = 0; i < 100000; ++i) {
+            [[maybe_unused]] const std::uint32_t code = dict.encode(i << 12);
+            assert(code == i);
+        }
+        assert(dict.size() == 100000 && dict.code_width() == 17);
+        for(std::uint32_t i = 0; i < 100000; ++i) {
+            assert(dict.find(i << 12) == i);
+            assert(dict.decode(i) == i << 12);
+        }
+        assert(dict.find(1) == bitpack::dictionary::npos);
+        dict.clear();
+        assert(dict.empty() && dict.find(0) == bitpack::dictionary::npos);
+    }
+
+    // Test batch encoding and decoding
+    {
+        std::vector<std::uint32_t> ids(1000);
+        for(size_t i = 0; i < ids.size(); ++i) { ids[i] = static_cast<std::uint32_t>((i % 37) * 2654435761u); }
+        bitpack::dictionary dict;
+        std::vector<std::uint32_t> codes(ids.size());
+        dict.encode(ids.data(), ids.size(), codes.data());
+        assert(dict.size() == 37);
+        for(size_t i = 0; i < ids.size(); ++i) { assert(codes[i] == i % 37); }
+        std::vector<std::uint32_t> decoded(ids.size());
+        dict.decode(codes.data(), codes.size(), decoded.data());
+        assert(decoded == ids);
+    }
+
+    // Test storing IDs in a narrow bitpack field
+    {
+        using record = bitpack::bitpack<bitpack::small_layout<bitpack::bitwidth<3>, bitpack::bitwidth<6>>>;
+        std::vector<record> records(200);
+        std::vector<std::uint32_t> ids(records.size());
+        for(size_t i = 0; i < ids.size(); ++i) { ids[i] = 4000000000u + static_cast<std::uint32_t>(i % 50) * 11; }
+
+        bitpack::dictionary dict;
+        [[maybe_unused]] const bool encoded = dict.encode_field<1>(records, ids);
+        assert(encoded);
+        assert(dict.code_width() == 6);
+        assert(records[51].get<1>() == 1 && records[51].get<0>() == 0);
+        std::vector<std::uint32_t> decoded(records.size());
+        dict.decode_field<1>(records, decoded.data());
+        assert(decoded == ids);
+
+        // Test that codes too wide for the field are refused
+        bitpack::dictionary small;
+        [[maybe_unused]] const bool refused = !small.encode_field<0>(records, ids);
+        assert(refused);
+        assert(records[51].get<0>() == 0);
+
+        // Test that a refused call leaves the dictionary as it was, so it can still fill a field that fits
+        [[maybe_unused]] const std::uint32_t kept = small.encode(17);
+        const std::vector<std::uint32_t> few(records.size(), 17);
+        [[maybe_unused]] const bool partly_refused = !small.encode_field<0>(records, ids);
+        assert(kept == 0 && partly_refused && small.size() == 1 && small.find(17) == 0);
+        assert(small.find(ids[1]) == bitpack::dictionary::npos);
+        [[maybe_unused]] const bool fitted = small.encode_field<0>(records, few);
+        assert(fitted && small.size() == 1 && records[51].get<0>() == 0);
+    }
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
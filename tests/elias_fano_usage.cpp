@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <bitpack/elias_fano.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main() {
+    // Test a small sequence by hand, including repeated values
+    {
+        const std::vector<std::uint32_t> values = { 3, 4, 7, 13, 14, 15, 21, 21, 43 };
+        const bitpack::elias_fano<std::uint32_t> sequence(values);
+        assert(sequence.size() == 9 && sequence.universe() == 44 && sequence.low_width() == 2);
+        for(size_t i = 0; i < values.size(); ++i) { assert(sequence[i] == values[i]); }
+        assert(sequence.next_geq(0) == 0);
+        assert(sequence.next_geq(5) == 2);
+        assert(sequence.next_geq(16) == 6);
+        assert(sequence.next_geq(21) == 6);
+        assert(sequence.next_geq(22) == 8);
+        assert(sequence.next_geq(43) == 8);
+        assert(sequence.next_geq(44) == 9);
+    }
+
+    // Sorted random values spread over a large universe
+    std::mt19937_64 rng(39);
+    std::vector<std::uint64_t> values(100000);
+    for(auto& v : values) { v = rng() % (std::uint64_t(1) << 40); }
+    std::sort(values.begin(), values.end());
+    const bitpack::elias_fano<> sequence(values);
+
+    // Test random access and decoding
+    for(size_t i = 0; i < values.size(); i += 13) { assert(sequence.access(i) == values[i]); }
+    std::vector<std::uint64_t> decoded(values.size());
+    sequence.decode(decoded.data());
+    assert(decoded == values);
+    size_t visited = 0;
+    sequence.for_each([&]([[maybe_unused]] std::uint64_t v) {
+        assert(v == values[visited]);
+        ++visited;
+    });
+    assert(visited == values.size());
+
+    // Test successor queries against a binary search
+    for(size_t q = 0; q < 10000; ++q) {
+        const std::uint64_t x = rng() % (std::uint64_t(1) << 40);
+        [[maybe_unused]] const auto expected = std::lower_bound(values.begin(), values.end(), x) - values.begin();
+        assert(sequence.next_geq(x) == static_cast<size_t>(expected));
+    }
+
+    // Test that the encoding stays near 2 + log2(universe / n) bits per value
+    [[maybe_unused]] const double bits_per_value =
+        static_cast<double>(sequence.size_in_bytes() * 8) / static_cast<double>(values.size());
+    assert(sequence.low_width() == 23 && bits_per_value < 2 + 24 + 1);
+
+    // Test dense sequences with no low bits and an empty sequence
+    std::vector<std::uint32_t> dense(1000);
+    for(size_t i = 0; i < dense.size(); ++i) { dense[i] = static_cast<std::uint32_t>(i / 2); }
+    const bitpack::elias_fano<std::uint32_t> dense_sequence(dense);
+    assert(dense_sequence.low_width() == 0 && dense_sequence[999] == 499 && dense_sequence.next_geq(250) == 500);
+    std::vector<std::uint32_t> dense_decoded(dense.size());
+    dense_sequence.decode(dense_decoded.data());
+    assert(dense_decoded == dense);
+
+    const bitpack::elias_fano<> empty(std::vector<std::uint64_t> {});
+    assert(empty.empty() && empty.next_geq(0) == 0);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
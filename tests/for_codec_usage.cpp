@@ -0,0 +1,62 @@
+#include <bitpack/for_codec.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main() {
+    std::mt19937_64 rng(3);
+
+    // Clustered timestamps: a large base with small increments
+    std::vector<std::uint64_t> timestamps(1000);
+    std::uint64_t ts = 1700000000000ULL;
+    for(auto& t : timestamps) {
+        ts += rng() % 16;
+        t = ts;
+    }
+
+    // Test that a column round trips, including a partial last block
+    const bitpack::for_column<> column(timestamps);
+    assert(column.size() == 1000);
+    assert(column.block_count() == 8);
+    std::vector<std::uint64_t> decoded(column.size());
+    column.decode(decoded.data());
+    assert(decoded == timestamps);
+
+    // Test that random access decodes single values
+    for(size_t i = 0; i < timestamps.size(); i += 37) { assert(column[i] == timestamps[i]); }
+
+    // Test that blocks are packed at the minimal width and the column is much smaller than the input
+    assert(column.block_base(0) == timestamps[0]);
+    assert(column.block_width(0) <= 11);
+    assert(column.size_in_bytes() * 4 < timestamps.size() * sizeof(std::uint64_t));
+
+    // Test that constant blocks take no packed words, and that full width values are handled
+    std::vector<std::uint64_t> mixed(256, 42);
+    mixed.push_back(0);
+    mixed.push_back(~std::uint64_t(0));
+    const bitpack::for_column<std::uint64_t, 256> mixed_column(mixed);
+    assert(mixed_column.block_width(0) == 0);
+    assert(mixed_column.block_width(1) == 64);
+    std::vector<std::uint64_t> mixed_decoded(mixed.size());
+    mixed_column.decode(mixed_decoded.data());
+    assert(mixed_decoded == mixed);
+    assert(mixed_column[257] == ~std::uint64_t(0));
+
+    // Test narrower value types and every width
+    for(size_t w = 0; w <= 32; ++w) {
+        std::vector<std::uint32_t> values(300);
+        for(auto& v : values) { v = static_cast<std::uint32_t>(100 + (rng() & bitpack::detail::low_mask(w))); }
+        const bitpack::for_column<std::uint32_t> narrow(values);
+        std::vector<std::uint32_t> narrow_decoded(values.size());
+        narrow.decode(narrow_decoded.data());
+        assert(narrow_decoded == values);
+        assert(narrow.block_width(0) <= w);
+    }
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/group_aggregate.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+int main() {
+    enum class event_idx {
+        Type    = 0,
+        Region  = 1,
+        Latency = 2,
+        User    = 3
+    };
+    using event_layout =
+        bitpack::fast_layout<bitpack::bitwidth<4>, bitpack::bitwidth<10>, bitpack::bitwidth<20>, bitpack::bitwidth<30>>;
+    using event = bitpack::bitpack<event_layout>;
+
+    std::mt19937_64 rng(7);
+    std::vector<event> events(200000);
+    std::map<std::uint64_t, std::pair<std::uint64_t, std::uint64_t>> expected_small;
+    std::map<std::uint64_t, std::pair<std::uint64_t, std::uint64_t>> expected_large;
+    for(auto& e : events) {
+        e.set<event_idx::Type>(rng() % 16);
+        e.set<event_idx::Region>(rng() % 1000);
+        e.set<event_idx::Latency>(rng() % 100000);
+        e.set<event_idx::User>(rng() % 5000);
+
+        auto& small = expected_small[(std::uint64_t(e.get<event_idx::Type>()) << 10) | e.get<event_idx::Region>()];
+        ++small.first;
+        small.second += e.get<event_idx::Latency>();
+
+        auto& large = expected_large[e.get<event_idx::User>()];
+        ++large.first;
+        large.second = std::max<std::uint64_t>(large.second, e.get<event_idx::Latency>());
+    }
+
+    // Test the direct indexed path (14 bit key), single and multi threaded
+    for(size_t threads : { 1, 3 }) {
+        const auto groups = bitpack::group_aggregate<event_idx::Type, event_idx::Region>(
+            events, bitpack::value_field<event_idx::Latency>, bitpack::sum_aggregate {}, threads);
+        assert(groups.size() == expected_small.size());
+        auto it = expected_small.begin();
+        for([[maybe_unused]] const auto& group : groups) {
+            assert(group.key == it->first);
+            assert(group.count == it->second.first);
+            assert(group.value == it->second.second);
+            ++it;
+        }
+    }
+
+    // Test the hash table path (30 bit key), single and multi threaded
+    for(size_t threads : { 1, 3 }) {
+        const auto groups = bitpack::group_aggregate<event_idx::User>(
+            events, bitpack::value_field<event_idx::Latency>, bitpack::max_aggregate {}, threads);
+        assert(groups.size() == expected_large.size());
+        auto it = expected_large.begin();
+        for([[maybe_unused]] const auto& group : groups) {
+            assert(group.key == it->first);
+            assert(group.count == it->second.first);
+            assert(group.value == it->second.second);
+            ++it;
+        }
+    }
+
+    // Test that an empty input produces no groups
+    const auto empty = bitpack::group_aggregate<0>(std::vector<event> {}, bitpack::value_field<2>, bitpack::min_aggregate {});
+    assert(empty.empty());
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/layout_analysis.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using packet_layout = bitpack::small_layout<bitpack::bitwidth<5>, bitpack::bitwidth<12>, bitpack::bitwidth<6>>;
+
+int main() {
+    // Test the analysis of a layout at compile time
+    constexpr auto analysis = bitpack::analyze_layout<packet_layout>();
+    static_assert(analysis.field_count == 3 && analysis.total_bits == 23);
+    static_assert(analysis.storage_bits == 32 && analysis.wasted_bits == 9);
+    static_assert(analysis.small_storage_bits == 32 && analysis.bytes_per_million(bitpack::storage_preference::SMALL) == 4000000);
+    static_assert(analysis.fields[1].offset == 5 && analysis.fields[1].mask == 0x1FFE0);
+    static_assert(!analysis.fields[0].straddles_byte && analysis.fields[1].straddles_byte && !analysis.fields[2].straddles_byte);
+    static_assert(!analysis.fields[2].straddles_word);
+    static_assert(analysis.fast_storage_bits == sizeof(std::uint_fast32_t) * 8);
+
+    // Test the shifts and masks get and set need: the field at bit 0 needs no shift, the others need both
+    static_assert(analysis.fields[0].get_ops == 1 && analysis.fields[0].set_ops == 2);
+    static_assert(analysis.fields[1].get_ops == 2 && analysis.fields[1].set_ops == 3);
+    {
+        using top_layout = bitpack::small_layout<bitpack::bitwidth<24>, bitpack::bitwidth<8>>;
+        constexpr auto top = bitpack::analyze_layout<top_layout>();
+        static_assert(top.fields[1].offset == 24 && top.fields[1].get_ops == 1 && top.fields[1].set_ops == 3);
+        using whole_layout = bitpack::small_layout<bitpack::bitwidth<16>>;
+        static_assert(bitpack::analyze_layout<whole_layout>().fields[0].get_ops == 0);
+    }
+
+    // Test that MSB first layouts report their own offsets
+    using sortable = bitpack::fast_sortable_layout<bitpack::bitwidth<30>, bitpack::bitwidth<20>>;
+    constexpr auto sortable_analysis = bitpack::analyze_layout<sortable>();
+    static_assert(sortable_analysis.fields[0].offset == 20 && sortable_analysis.fields[0].straddles_word);
+    static_assert(sortable_analysis.fields[1].mask == 0xFFFFF && sortable_analysis.storage_bits == 64);
+
+    // Test the report
+    std::ostringstream report;
+    bitpack::write_layout_analysis<packet_layout>(report);
+    const std::string text = report.str();
+    assert(text.find("bitwidth<12>") != std::string::npos);
+    assert(text.find("storage bits: 32 (9 wasted)") != std::string::npos);
+    assert(text.find("field 1: width 12, offset 5, mask 0x1ffe0, straddles a byte") != std::string::npos);
+    assert(text.find("field 2: width 6, offset 17, mask 0x7e0000, get 2 ops, set 3 ops\n") != std::string::npos);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/layout_fingerprint.hpp>
+#include <bitpack/optimized_layout.hpp>
+#include <cassert>
+#include <iostream>
+
+enum class fields {
+    ID,
+    AGE
+};
+
+enum class renamed {
+    ID,
+    AGE
+};
+
+using bitpack::bitwidth;
+using bitpack::field_tag;
+using bitpack::layout_fingerprint_v;
+
+int main() {
+    using base = bitpack::fast_layout<bitwidth<20, field_tag<fields::ID>>, bitwidth<7, field_tag<fields::AGE>>>;
+
+    // Test that the fingerprint ignores the storage preference and the enum's name, but not the values of its tags
+    static_assert(layout_fingerprint_v<base> ==
+                  layout_fingerprint_v<
+                      bitpack::small_layout<bitwidth<20, field_tag<fields::ID>>, bitwidth<7, field_tag<fields::AGE>>>>);
+    static_assert(layout_fingerprint_v<base> ==
+                  layout_fingerprint_v<
+                      bitpack::fast_layout<bitwidth<20, field_tag<renamed::ID>>, bitwidth<7, field_tag<renamed::AGE>>>>);
+    static_assert(layout_fingerprint_v<base> !=
+                  layout_fingerprint_v<
+                      bitpack::fast_layout<bitwidth<20, field_tag<fields::AGE>>, bitwidth<7, field_tag<fields::ID>>>>);
+
+    // Test that widths, offsets and untagged fields all change the fingerprint
+    using plain = bitpack::fast_layout<bitwidth<20>, bitwidth<7>>;
+    static_assert(layout_fingerprint_v<base> != layout_fingerprint_v<plain>);
+    static_assert(layout_fingerprint_v<plain> != layout_fingerprint_v<bitpack::fast_layout<bitwidth<20>, bitwidth<8>>>);
+    static_assert(layout_fingerprint_v<plain> != layout_fingerprint_v<bitpack::fast_sortable_layout<bitwidth<20>, bitwidth<7>>>);
+    static_assert(layout_fingerprint_v<plain> !=
+                  layout_fingerprint_v<bitpack::fast_layout<bitwidth<20>, bitwidth<7, field_tag<fields::AGE>>>>);
+    using hints = bitpack::layout_hints<bitpack::storage_preference::FAST, 2>;
+    static_assert(layout_fingerprint_v<bitpack::fast_layout<bitwidth<4>, bitwidth<8>, bitwidth<12>>> !=
+                  layout_fingerprint_v<bitpack::optimized_layout<hints, bitwidth<4>, bitwidth<8>, bitwidth<12>>>);
+
+    // Test finding versions in a history
+    using history = bitpack::layout_history<base, plain>;
+    static_assert(history::version_count == 2);
+    static_assert(history::find(layout_fingerprint_v<base>) == 0);
+    static_assert(history::find(layout_fingerprint_v<plain>) == 1);
+    static_assert(history::find(0) == 2);
+    static_assert(std::is_same_v<history::version<1>, plain>);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/mmap_packed_array.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() {
+    [[maybe_unused]] bitpack::packed_file_status status;
+    using record_layout = bitpack::fast_layout<bitpack::bitwidth<16>, bitpack::bitwidth<8>, bitpack::bitwidth<40>>;
+    using other_layout  = bitpack::fast_layout<bitpack::bitwidth<16>, bitpack::bitwidth<9>, bitpack::bitwidth<39>>;
+    using record        = bitpack::bitpack<record_layout>;
+
+    const std::string path = std::string(P_tmpdir) + "/bitpack_mmap_packed_array_test.bin";
+
+    std::vector<record> records(1000);
+    for(size_t i = 0; i < records.size(); ++i) {
+        records[i].set<0>(i);
+        records[i].set<1>(i % 256);
+        records[i].set<2>(i * 1000003);
+    }
+    status = bitpack::write_packed_file(path.c_str(), records);
+    assert(status == bitpack::packed_file_status::OK);
+
+    // Test that records are readable in place through a read-only mapping
+    {
+        bitpack::mmap_packed_array<record_layout> mapped;
+        status = mapped.open(path.c_str());
+        assert(status == bitpack::packed_file_status::OK);
+        assert(mapped.is_open() && !mapped.is_writable());
+        assert(mapped.size() == records.size());
+        for(size_t i = 0; i < records.size(); ++i) {
+            assert(mapped[i] == records[i]);
+            assert(mapped.get<2>(i) == i * 1000003);
+        }
+    }
+
+    // Test that a file written for a different layout fails to open
+    {
+        bitpack::mmap_packed_array<other_layout> mismatched;
+        status = mismatched.open(path.c_str());
+        assert(status == bitpack::packed_file_status::SCHEMA_MISMATCH);
+        assert(!mismatched.is_open());
+        using sortable_layout =
+            bitpack::fast_sortable_layout<bitpack::bitwidth<16>, bitpack::bitwidth<8>, bitpack::bitwidth<40>>;
+        bitpack::mmap_packed_array<sortable_layout> reordered;
+        status = reordered.open(path.c_str());
+        assert(status == bitpack::packed_file_status::SCHEMA_MISMATCH);
+    }
+
+    // Test that changes through a read-write mapping are written to the file
+    {
+        bitpack::mmap_packed_array<record_layout> mapped;
+        status = mapped.open(path.c_str(), bitpack::map_mode::READ_WRITE);
+        assert(status == bitpack::packed_file_status::OK);
+        mapped.set<1>(10, 200);
+        [[maybe_unused]] const bool synced = mapped.sync();
+        assert(synced);
+    }
+    {
+        bitpack::mmap_packed_array<record_layout> mapped;
+        status = mapped.open(path.c_str());
+        assert(status == bitpack::packed_file_status::OK);
+        assert(mapped.get<1>(10) == 200);
+        assert(mapped.get<0>(10) == 10);
+
+        // Test that moving a mapping transfers ownership
+        bitpack::mmap_packed_array<record_layout> moved = std::move(mapped);
+        assert(!mapped.is_open() && moved.is_open());
+        assert(moved.get<0>(999) == 999);
+    }
+
+    // Test creating a zeroed file
+    {
+        bitpack::mmap_packed_array<record_layout> created;
+        status = created.create(path.c_str(), 50);
+        assert(status == bitpack::packed_file_status::OK);
+        assert(created.size() == 50 && created.get<2>(49) == 0);
+        created.set<2>(49, 12345);
+    }
+
+    // Test that truncated and missing files fail to open
+    {
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        std::fseek(file, 0, SEEK_END);
+        const long full = std::ftell(file);
+        std::fclose(file);
+        [[maybe_unused]] const int truncated = ::truncate(path.c_str(), full - 8);
+        assert(truncated == 0);
+
+        bitpack::mmap_packed_array<record_layout> mapped;
+        status = mapped.open(path.c_str());
+        assert(status == bitpack::packed_file_status::TRUNCATED);
+        status = mapped.open((path + ".missing").c_str());
+        assert(status == bitpack::packed_file_status::OPEN_FAILED);
+    }
+    std::remove(path.c_str());
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/detail/bits.hpp>
+#include <bitpack/optimized_layout.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+enum class order_field {
+    PRICE,
+    QUANTITY,
+    SIDE,
+    VENUE,
+    STATUS
+};
+
+using hints        = bitpack::layout_hints<bitpack::storage_preference::SMALL, order_field::STATUS, order_field::SIDE>;
+using order_layout = bitpack::optimized_layout<hints,
+                                               bitpack::bitwidth<20>,
+                                               bitpack::bitwidth<14>,
+                                               bitpack::bitwidth<1>,
+                                               bitpack::bitwidth<9>,
+                                               bitpack::bitwidth<3>>;
+using order        = bitpack::bitpack<order_layout>;
+
+constexpr order make_order() {
+    order o;
+    o.set<order_field::PRICE>(1000000);
+    o.set<order_field::QUANTITY>(16000);
+    o.set<order_field::SIDE>(1);
+    o.set<order_field::VENUE>(300);
+    o.set<order_field::STATUS>(5);
+    return o;
+}
+
+int main() {
+    static_assert(order_layout::storage_bits == 64);
+
+    // Test that the hottest field is at bit 0 and the second hottest at the top of the storage word
+    static_assert(order_layout::field_offsets[4] == 0);
+    static_assert(order_layout::field_offsets[2] == 63);
+
+    // Test that the fields reach past the layout's total width to the top of the storage word, which bitpack checks
+    // against the storage its detector picks
+    static_assert(bitpack::layout_traits<order_layout>::total_bitwidth < 64);
+    static_assert(bitpack::detail::field_extent(order_layout::field_sizes, order_layout::field_offsets) == 64);
+
+    // Test that the cold fields are placed to touch as few bytes as possible: the 20 bit field fits in 3 bytes right
+    // after the status, the 9 bit field fills out the low half, and the 14 bit field starts the high half
+    static_assert(order_layout::field_offsets[0] == 3);
+    static_assert(order_layout::field_offsets[3] == 23);
+    static_assert(order_layout::field_offsets[1] == 32);
+    static_assert(bitpack::detail::straddle_cost(0, 8, 64) == 0 && bitpack::detail::straddle_cost(4, 8, 64) == 1);
+    static_assert(bitpack::detail::straddle_cost(30, 4, 64) == 5);
+
+    // Test that fields are still accessed by their declared index
+    constexpr order o = make_order();
+    static_assert(o.get<order_field::PRICE>() == 1000000 && o.get<order_field::QUANTITY>() == 16000);
+    static_assert(o.get<order_field::SIDE>() == 1 && o.get<order_field::VENUE>() == 300 && o.get<order_field::STATUS>() == 5);
+    static_assert((o.data() & 0x7) == 5 && (o.data() >> 63) == 1);
+
+    // Test that no two fields overlap
+    {
+        order full;
+        full.set<0>(bitpack::bitmask_v<std::uint32_t, 20>);
+        full.set<1>(bitpack::bitmask_v<std::uint32_t, 14>);
+        full.set<2>(1);
+        full.set<3>(bitpack::bitmask_v<std::uint32_t, 9>);
+        full.set<4>(bitpack::bitmask_v<std::uint32_t, 3>);
+        assert(bitpack::detail::popcount(full.data()) == 47);
+        full.set<1>(0);
+        assert((full.get<0>() == bitpack::bitmask_v<std::uint32_t, 20> && full.get<2>() == 1));
+    }
+
+    // Test a layout without hints, which is only reordered to avoid straddles
+    {
+        using plain = bitpack::optimized_layout<bitpack::layout_hints<bitpack::storage_preference::SMALL>,
+                                                bitpack::bitwidth<4>,
+                                                bitpack::bitwidth<8>,
+                                                bitpack::bitwidth<4>>;
+        static_assert(plain::storage_bits == 16);
+        static_assert(plain::field_offsets[1] == 0 && plain::field_offsets[0] == 8 && plain::field_offsets[2] == 12);
+        bitpack::bitpack<plain> p;
+        p.set<0>(0xA);
+        p.set<1>(0xBC);
+        p.set<2>(0xD);
+        assert(p.data() == 0xDABC);
+    }
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
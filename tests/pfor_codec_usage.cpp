@@ -0,0 +1,63 @@
+#include <array>
+#include <bitpack/for_codec.hpp>
+#include <bitpack/pfor_codec.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main() {
+    // Test that the width selection trades packed bits against exceptions
+    std::array<size_t, 65> width_counts {};
+    width_counts[4]  = 127;
+    width_counts[20] = 1;
+    assert(bitpack::detail::pfor_best_width(width_counts, 128, 64, 72) == 4);
+    width_counts[20] = 64;
+    assert(bitpack::detail::pfor_best_width(width_counts, 128, 64, 72) == 20);
+
+    // Latencies clustered around a median with 0.1% of values 1000x larger
+    std::mt19937_64 rng(11);
+    std::vector<std::uint32_t> latencies(100000);
+    for(auto& l : latencies) {
+        l = 500 + static_cast<std::uint32_t>(rng() % 200);
+        if(rng() % 1000 == 0) {
+            l *= 1000;
+        }
+    }
+
+    // Test that a column round trips, including a partial last block
+    const bitpack::pfor_column<std::uint32_t> column(latencies);
+    std::vector<std::uint32_t> decoded(column.size());
+    column.decode(decoded.data());
+    assert(decoded == latencies);
+
+    // Test that random access patches exceptions
+    for(size_t i = 0; i < latencies.size(); ++i) { assert(column[i] == latencies[i]); }
+
+    // Test that outliers no longer force whole blocks to a wide width
+    const bitpack::for_column<std::uint32_t> plain(latencies);
+    size_t exceptions = 0;
+    for(size_t b = 0; b < column.block_count(); ++b) {
+        assert(column.block_width(b) <= 8);
+        exceptions += column.block_exceptions(b);
+    }
+    assert(exceptions > 0);
+    assert(column.size_in_bytes() < plain.size_in_bytes());
+
+    // Test a 256 value block of 64 bit values with full width outliers
+    std::vector<std::uint64_t> wide(600, 7);
+    wide[3]   = ~std::uint64_t(0);
+    wide[300] = std::uint64_t(1) << 63;
+    const bitpack::pfor_column<std::uint64_t, 256> wide_column(wide);
+    std::vector<std::uint64_t> wide_decoded(wide.size());
+    wide_column.decode(wide_decoded.data());
+    assert(wide_decoded == wide);
+    assert(wide_column[3] == ~std::uint64_t(0));
+    assert(wide_column.block_exceptions(0) == 1);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/radix_sort.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main() {
+    enum class record_idx {
+        Tenant = 0,
+        Shard  = 1,
+        Ts     = 2,
+        Seq    = 3
+    };
+    using record_layout =
+        bitpack::fast_layout<bitpack::bitwidth<10>, bitpack::bitwidth<6>, bitpack::bitwidth<30>, bitpack::bitwidth<18>>;
+    using record        = bitpack::bitpack<record_layout>;
+
+    // Check that digit counts and widths are derived from the key fields
+    using tenant_ts_key = bitpack::detail::radix_key<record, record_idx::Tenant, record_idx::Ts>;
+    static_assert(tenant_ts_key::total_bits == 40);
+    static_assert(tenant_ts_key::digit_count == 4);
+    static_assert(tenant_ts_key::digit_bits == 10);
+    static_assert(bitpack::detail::radix_key<record, 1>::digit_count == 1);
+
+    std::mt19937_64 rng(42);
+    std::vector<record> records(300000);
+    for(size_t i = 0; i < records.size(); ++i) {
+        records[i].set<record_idx::Tenant>(rng() % 20);
+        records[i].set<record_idx::Shard>(rng() % 64);
+        records[i].set<record_idx::Ts>(rng() % 1000);
+        // The sequence number records the original order so stability can be checked
+        records[i].set<record_idx::Seq>(i % (1 << 18));
+    }
+
+    const auto by_tenant_ts = [](const record& lhs, const record& rhs) {
+        if(lhs.get<record_idx::Tenant>() != rhs.get<record_idx::Tenant>()) {
+            return lhs.get<record_idx::Tenant>() < rhs.get<record_idx::Tenant>();
+        }
+        return lhs.get<record_idx::Ts>() < rhs.get<record_idx::Ts>();
+    };
+
+    auto expected = records;
+    std::stable_sort(expected.begin(), expected.end(), by_tenant_ts);
+
+    // Test that the single threaded sort is stable and matches std::stable_sort
+    auto sorted = records;
+    bitpack::radix_sort<record_idx::Tenant, record_idx::Ts>(sorted);
+    assert(sorted == expected);
+
+    // Test that the multi threaded sort produces the same result
+    auto sorted_mt = records;
+    bitpack::radix_sort<record_idx::Tenant, record_idx::Ts>(sorted_mt, 4);
+    assert(sorted_mt == expected);
+
+    // Test that sorting by a constant field skips every pass and leaves the order intact
+    auto constant = records;
+    for(auto& r : constant) { r.set<record_idx::Shard>(7); }
+    auto constant_sorted = constant;
+    bitpack::radix_sort<record_idx::Shard>(constant_sorted, 2);
+    assert(constant_sorted == constant);
+
+    // Test that small inputs and raw arrays work
+    std::array<record, 3> small {};
+    small[0].set<0>(3);
+    small[1].set<0>(1);
+    small[2].set<0>(2);
+    bitpack::radix_sort<0>(small);
+    assert(small[0].get<0>() == 1 && small[1].get<0>() == 2 && small[2].get<0>() == 3);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
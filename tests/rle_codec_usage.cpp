@@ -0,0 +1,73 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/rle_codec.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main() {
+    // Test a small column by hand
+    {
+        const std::vector<std::uint32_t> values = { 5, 5, 5, 1, 1, 9, 5, 5 };
+        const bitpack::rle_column<std::uint32_t> column(values);
+        assert(column.size() == 8 && column.run_count() == 4);
+        assert(column.value_width() == 4 && column.length_width() == 2);
+        assert(column.run_value(2) == 9 && column.run_length(2) == 1 && column.run_start(2) == 5);
+        assert(column.find_run(0) == 0 && column.find_run(2) == 0 && column.find_run(3) == 1 && column.find_run(7) == 3);
+        for(size_t i = 0; i < values.size(); ++i) { assert(column[i] == values[i]); }
+
+        // Test predicates and aggregates over runs
+        assert(column.count(5, 9) == 6 && column.count(2, 4) == 0);
+        assert(column.sum() == 5 * 5 + 1 * 2 + 9);
+        assert(column.min() == 1 && column.max() == 9);
+        std::vector<size_t> starts;
+        column.scan(5, 5, [&](size_t start, [[maybe_unused]] size_t length) {
+            starts.push_back(start);
+            assert(length == (start == 0 ? 3 : 2));
+        });
+        assert((starts == std::vector<size_t> { 0, 6 }));
+    }
+
+    // Long runs spanning many index samples
+    std::mt19937_64 rng(37);
+    std::vector<std::uint64_t> values;
+    while(values.size() < 100000) { values.insert(values.end(), 1 + rng() % 300, rng() % 1000); }
+
+    // Test that the column round trips and finds every row's run
+    const bitpack::rle_column<> column(values);
+    std::vector<std::uint64_t> decoded(values.size());
+    column.decode(decoded.data());
+    assert(decoded == values);
+    for(size_t i = 0; i < values.size(); i += 7) { assert(column[i] == values[i]); }
+    assert(column[values.size() - 1] == values.back());
+    assert(column.size_in_bytes() < values.size());
+
+    size_t expected_count = 0;
+    std::uint64_t expected_sum = 0;
+    for(const std::uint64_t v : values) {
+        expected_count += v >= 100 && v <= 199;
+        expected_sum += v;
+    }
+    assert(column.count(100, 199) == expected_count);
+    assert(column.sum() == expected_sum);
+
+    // Test encoding a bitpack field at the field's width
+    using record = bitpack::bitpack<bitpack::fast_layout<bitpack::bitwidth<11>, bitpack::bitwidth<21>>>;
+    std::vector<record> records(values.size());
+    for(size_t i = 0; i < records.size(); ++i) { records[i].set<0>(values[i]); }
+    const auto field = bitpack::rle_column<std::uint32_t>::from_field<0>(records);
+    assert(field.value_width() == 11 && field.run_count() == column.run_count());
+    std::vector<record> restored(records.size());
+    field.decode_field<0>(restored);
+    assert(restored == records);
+
+    // Test an empty column
+    const bitpack::rle_column<> empty(std::vector<std::uint64_t> {});
+    assert(empty.size() == 0 && empty.run_count() == 0 && empty.sum() == 0);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
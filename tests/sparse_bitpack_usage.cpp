@@ -0,0 +1,145 @@
+#include <bitpack/bit_stream.hpp>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/sparse_bitpack.hpp>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+enum class event_field {
+    USER,
+    SESSION,
+    FLAGS,
+    LATENCY,
+    ERROR_CODE
+};
+
+using event_layout =
+    bitpack::layout<bitpack::storage_preference::SMALL,
+                    bitpack::bitwidth<20>,
+                    bitpack::bitwidth<12>,
+                    bitpack::bitwidth<3>,
+                    bitpack::bitwidth<12>,
+                    bitpack::bitwidth<8>>;
+using event         = bitpack::sparse_bitpack<event_layout>;
+using compact_event = bitpack::sparse_bitpack<event_layout, 27>;
+
+// Sixteen byte-wide fields, of which a record carries at most six
+using wide_layout =
+    bitpack::small_layout<bitpack::bitwidth<8>, bitpack::bitwidth<8>, bitpack::bitwidth<8>, bitpack::bitwidth<8>,
+                          bitpack::bitwidth<8>, bitpack::bitwidth<8>, bitpack::bitwidth<8>, bitpack::bitwidth<8>,
+                          bitpack::bitwidth<8>, bitpack::bitwidth<8>, bitpack::bitwidth<8>, bitpack::bitwidth<8>,
+                          bitpack::bitwidth<8>, bitpack::bitwidth<8>, bitpack::bitwidth<8>, bitpack::bitwidth<8>>;
+using wide_record = bitpack::sparse_bitpack<wide_layout, 48>;
+
+constexpr event make_event() {
+    event e;
+    e.set<event_field::LATENCY>(400);
+    e.set<event_field::USER>(77);
+    return e;
+}
+
+int main() {
+    // Test that storage is sized by the payload capacity rather than by every field
+    static_assert(sizeof(event) == sizeof(bitpack::bitpack<event_layout>));
+    static_assert(sizeof(compact_event) == 4 && sizeof(compact_event) < sizeof(bitpack::bitpack<event_layout>));
+    static_assert(sizeof(wide_record) == 8 && sizeof(wide_record) * CHAR_BIT < 16 * 8);
+
+    // Test that present fields are packed in field order right after the presence mask
+    constexpr event sparse = make_event();
+    static_assert(sparse.mask() == 0b01001);
+    static_assert(sparse.get<event_field::USER>() == 77 && sparse.get<event_field::LATENCY>() == 400);
+    static_assert(sparse.get<event_field::SESSION>() == 0 && !sparse.has<event_field::SESSION>());
+    static_assert(sparse.size_in_bits() == 5 + 20 + 12);
+    static_assert(sparse.data() == (0b01001 | (77ull << 5) | (400ull << 25)));
+
+    // Test inserting and removing fields in the middle
+    {
+        event e = sparse;
+        e.set<event_field::SESSION>(4095);
+        e.set<event_field::FLAGS>(5);
+        assert(e.get<event_field::USER>() == 77 && e.get<event_field::SESSION>() == 4095);
+        assert(e.get<event_field::FLAGS>() == 5 && e.get<event_field::LATENCY>() == 400);
+        e.set<event_field::SESSION>(12);
+        assert(e.get<event_field::SESSION>() == 12 && e.get<event_field::FLAGS>() == 5);
+        e.reset<event_field::SESSION>();
+        e.reset<event_field::FLAGS>();
+        assert(e == sparse);
+        e.reset<event_field::ERROR_CODE>();
+        assert(e == sparse);
+    }
+
+    // Test that a record with every field present uses the dense offsets
+    {
+        event full;
+        full.set<event_field::ERROR_CODE>(200);
+        full.set<event_field::FLAGS>(7);
+        full.set<event_field::USER>(1);
+        full.set<event_field::LATENCY>(9);
+        full.set<event_field::SESSION>(2);
+        assert(full.mask() == 0b11111 && full.size_in_bits() == 60);
+        assert(full.get<4>() == 200 && full.get<2>() == 7 && full.get<0>() == 1 && full.get<3>() == 9 && full.get<1>() == 2);
+        assert(full.data() >> 52 == 200);
+        full.reset<event_field::ERROR_CODE>();
+        assert(full.size_in_bits() == 52 && full.get<event_field::LATENCY>() == 9);
+    }
+
+    // Test writing records to a bit stream at their sparse size and reading them back
+    {
+        std::vector<event> events(100);
+        for(size_t i = 0; i < events.size(); ++i) {
+            events[i].set<event_field::USER>(i);
+            if(i % 10 == 0) {
+                events[i].set<event_field::ERROR_CODE>(i);
+            }
+        }
+        std::vector<std::uint8_t> bytes;
+        {
+            bitpack::bit_writer writer(bitpack::vector_sink { bytes });
+            for(const event& e : events) { writer.write(e.data(), e.size_in_bits()); }
+        }
+        assert(bytes.size() == (100 * 25 + 10 * 8 + 7) / 8);
+
+        bitpack::bit_reader reader(bitpack::buffer_source { bytes.data(), bytes.size() });
+        for([[maybe_unused]] const event& e : events) {
+            const std::uint64_t mask                  = reader.read(5);
+            [[maybe_unused]] const std::uint64_t rest = reader.read(event::size_in_bits(mask) - 5);
+            assert(event(mask | (rest << 5)) == e);
+        }
+    }
+
+    // Test a compact record holding the few fields it carries
+    {
+        compact_event e;
+        e.set<event_field::ERROR_CODE>(200);
+        e.set<event_field::SESSION>(4000);
+        e.set<event_field::FLAGS>(3);
+        assert(e.size_in_bits() == 5 + 12 + 3 + 8 && e.get<event_field::ERROR_CODE>() == 200);
+        assert(!compact_event::fits(e.mask() | 0b01000) && compact_event::fits((e.mask() ^ 0b00010) | 0b01000));
+        e.reset<event_field::SESSION>();
+        e.set<event_field::LATENCY>(4095);
+        assert(e.size_in_bits() == 28 && e.get<event_field::LATENCY>() == 4095 && e.get<event_field::FLAGS>() == 3);
+        assert(e.get<event_field::ERROR_CODE>() == 200 && !e.has<event_field::SESSION>());
+    }
+
+    // Test a record whose dense layout wouldn't fit in 64 bits
+    {
+        wide_record r;
+        for(size_t i = 0; i < 16; ++i) { assert(wide_record::fits(std::uint64_t(0b111111) << i % 11)); }
+        assert(!wide_record::fits(0b1111111));
+        r.set<15>(0xAB);
+        r.set<3>(0x12);
+        r.set<9>(0xFF);
+        r.set<0>(0x01);
+        assert(r.mask() == 0b1000001000001001 && r.size_in_bits() == 16 + 32);
+        assert(r.get<0>() == 0x01 && r.get<3>() == 0x12 && r.get<9>() == 0xFF && r.get<15>() == 0xAB && r.get<7>() == 0);
+        r.reset<3>();
+        assert(r.get<9>() == 0xFF && r.get<15>() == 0xAB && r.size_in_bits() == 16 + 24);
+    }
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
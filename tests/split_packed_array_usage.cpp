@@ -0,0 +1,68 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/split_packed_array.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+enum class request_field {
+    ROUTE,
+    CLIENT,
+    PAYLOAD,
+    TRACE,
+    STATUS,
+    FLAGS
+};
+
+// 120 bits in total, more than one bitpack can hold, with a 20 bit hot part
+using request_layout = bitpack::small_layout<bitpack::bitwidth<12>,
+                                             bitpack::bitwidth<30>,
+                                             bitpack::bitwidth<40>,
+                                             bitpack::bitwidth<27>,
+                                             bitpack::bitwidth<8>,
+                                             bitpack::bitwidth<3>>;
+using request_array  = bitpack::split_packed_array<request_layout, request_field::ROUTE, request_field::STATUS>;
+
+int main() {
+    static_assert(request_array::hot_layout::field_sizes.size() == 2);
+    static_assert(sizeof(request_array::hot_type) == 4);
+    static_assert(request_array::cold_words == 2);
+
+    request_array requests(1000);
+    assert(requests.size() == 1000);
+    for(size_t i = 0; i < requests.size(); ++i) {
+        auto row = requests[i];
+        row.set<request_field::ROUTE>(i % 4096);
+        row.set<request_field::STATUS>(i % 256);
+        row.set<request_field::CLIENT>(i * 1000003 % (1u << 30));
+        // The payload straddles the two cold words
+        row.set<request_field::PAYLOAD>((std::uint64_t(1) << 39) | i);
+        row.set<request_field::TRACE>((1u << 27) - 1 - i);
+        row.set<request_field::FLAGS>(i % 8);
+    }
+
+    // Test that every field reads back through the proxy and directly
+    const request_array& view = requests;
+    for(size_t i = 0; i < view.size(); ++i) {
+        assert(view[i].get<request_field::ROUTE>() == i % 4096);
+        assert(view[i].get<request_field::STATUS>() == i % 256);
+        assert(view[i].get<request_field::CLIENT>() == i * 1000003 % (1u << 30));
+        assert(view.get<request_field::PAYLOAD>(i) == ((std::uint64_t(1) << 39) | i));
+        assert(view.get<request_field::TRACE>(i) == (1u << 27) - 1 - i);
+        assert(view.get<request_field::FLAGS>(i) == i % 8);
+    }
+
+    // Test that overwriting a straddling field leaves its neighbours alone
+    requests.set<request_field::PAYLOAD>(5, 0);
+    assert(requests.get<request_field::PAYLOAD>(5) == 0);
+    assert(requests.get<request_field::CLIENT>(5) == 5 * 1000003 && requests.get<request_field::TRACE>(5) == (1u << 27) - 6);
+
+    // Test that the hot array is a plain bitpack array holding only the hot fields
+    [[maybe_unused]] const request_array::hot_type& hot = requests.hot_data()[300];
+    assert(hot.get<0>() == 300 && hot.get<1>() == 300 % 256);
+    assert(requests.hot_bytes() * 4 == requests.cold_bytes());
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/optimized_layout.hpp>
+#include <bitpack/variant_bitpack.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+enum class point_field {
+    X,
+    Y
+};
+
+using point_layout  = bitpack::small_layout<bitpack::bitwidth<10>, bitpack::bitwidth<10>>;
+using span_layout   = bitpack::small_layout<bitpack::bitwidth<20>, bitpack::bitwidth<8>, bitpack::bitwidth<1>>;
+using marker_layout = bitpack::small_sortable_layout<bitpack::bitwidth<4>, bitpack::bitwidth<12>>;
+using shape_layout  = bitpack::variant_layout<2, point_layout, span_layout, marker_layout>;
+using shape         = bitpack::variant_bitpack<shape_layout>;
+
+struct describe {
+    constexpr std::uint64_t operator()(const bitpack::bitpack<point_layout>& p) const {
+        return 1000000 + p.get<point_field::X>() * 1000 + p.get<point_field::Y>();
+    }
+    constexpr std::uint64_t operator()(const bitpack::bitpack<span_layout>& s) const { return 2000000 + s.get<0>(); }
+    constexpr std::uint64_t operator()(const bitpack::bitpack<marker_layout>& m) const {
+        return 3000000 + m.get<0>() * 10000 + m.get<1>();
+    }
+};
+
+constexpr shape make_span() {
+    shape s;
+    s.emplace<1>();
+    s.set<1, 0>(123456);
+    s.set<1, 2>(1);
+    return s;
+}
+
+int main() {
+    static_assert(shape_layout::total_bitwidth == 2 + 29);
+    static_assert(sizeof(shape::storage_type) == 4);
+
+    // Test that fields follow the tag at the offsets of their own layout
+    constexpr shape span = make_span();
+    static_assert(span.index() == 1 && span.holds<1>() && !span.holds<0>());
+    static_assert(span.get<1, 0>() == 123456 && span.get<1, 1>() == 0 && span.get<1, 2>() == 1);
+    static_assert(span.data() == (1u | (123456u << 2) | (1u << 30)));
+    static_assert(span.visit(describe {}) == 2123456);
+
+    // Test that get and set match a flat bitpack with the tag as its first field
+    {
+        using flat_layout =
+            bitpack::small_layout<bitpack::bitwidth<2>, bitpack::bitwidth<20>, bitpack::bitwidth<8>, bitpack::bitwidth<1>>;
+        constexpr bitpack::bitpack<flat_layout> flat(span.data());
+        static_assert(flat.get<0>() == 1 && flat.get<1>() == span.get<1, 0>() && flat.get<3>() == span.get<1, 2>());
+    }
+
+    // Test switching alternatives and visiting each one
+    {
+        shape s = span;
+        s.emplace<0>();
+        s.set<0, point_field::X>(1023);
+        s.set<0, point_field::Y>(7);
+        assert((s.get<0, point_field::X>() == 1023 && s.get<0, point_field::Y>() == 7));
+        assert(s.visit(describe {}) == 1000000 + 1023 * 1000 + 7);
+
+        bitpack::bitpack<marker_layout> marker;
+        marker.set<0>(9);
+        marker.set<1>(4000);
+        s = shape::make<2>(marker);
+        assert(s.index() == 2 && s.as<2>() == marker);
+        assert((s.get<2, 0>() == 9 && s.get<2, 1>() == 4000));
+        assert(s.visit(describe {}) == 3000000 + 9 * 10000 + 4000);
+        assert(shape(s.data()) == s && s != span);
+    }
+
+    // Test that a storage word whose tag names no alternative is reported as invalid instead of being visited
+    {
+        constexpr shape corrupted(0b11 | (123u << 2));
+        static_assert(corrupted.index() == 3 && !corrupted.valid());
+        static_assert(span.valid() && shape().valid());
+    }
+
+    // Test an alternative with a gap between its fields, whose highest field sits past its total bitwidth
+    {
+        using gapped_layout = bitpack::optimized_layout<bitpack::layout_hints<bitpack::storage_preference::SMALL, 0, 1>,
+                                                        bitpack::bitwidth<4>,
+                                                        bitpack::bitwidth<6>,
+                                                        bitpack::bitwidth<3>>;
+        using tiny_layout   = bitpack::small_layout<bitpack::bitwidth<2>>;
+        using tiny          = bitpack::variant_bitpack<bitpack::variant_layout<1, tiny_layout, gapped_layout>>;
+        static_assert(bitpack::layout_traits<gapped_layout>::total_bitwidth == 13);
+        static_assert(tiny::layout_type::total_bitwidth == 1 + 16);
+
+        tiny t;
+        t.emplace<1>();
+        t.set<1, 0>(5);
+        t.set<1, 1>(63);
+        t.set<1, 2>(6);
+        assert((t.get<1, 1>() == 63 && t.as<1>().get<1>() == 63 && t.as<1>().get<2>() == 6));
+        assert(t.visit([](const auto& alternative) { return std::uint64_t(alternative.template get<0>()); }) == 5);
+    }
+
+    // Test a visitor with a reference to outside state
+    {
+        size_t visits = 0;
+        shape().visit([&](const auto&) { ++visits; });
+        make_span().visit([&](const auto& alternative) { visits += alternative.template get<0>() == 123456 ? 10 : 0; });
+        assert(visits == 11);
+    }
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
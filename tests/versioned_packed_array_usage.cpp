@@ -0,0 +1,106 @@
+#include <bitpack/bitpack.hpp>
+#include <bitpack/layout_fingerprint.hpp>
+#include <bitpack/mmap_packed_array.hpp>
+#include <bitpack/versioned_packed_array.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum class fields {
+    ID,
+    KIND,
+    SCORE
+};
+
+using bitpack::bitwidth;
+using bitpack::field_tag;
+
+using v1_layout = bitpack::fast_layout<bitwidth<20, field_tag<fields::ID>>, bitwidth<6, field_tag<fields::KIND>>>;
+// Version 2 widens KIND and adds SCORE
+using v2_layout = bitpack::fast_layout<bitwidth<20, field_tag<fields::ID>>,
+                                       bitwidth<10, field_tag<fields::KIND>>,
+                                       bitwidth<10, field_tag<fields::SCORE>>>;
+using history   = bitpack::layout_history<v2_layout, v1_layout>;
+using v1        = bitpack::bitpack<v1_layout>;
+using v2        = bitpack::bitpack<v2_layout>;
+
+int main() {
+    [[maybe_unused]] bitpack::packed_file_status status;
+    const std::string path = std::string(P_tmpdir) + "/bitpack_versioned_packed_array_test.bin";
+
+    std::vector<v1> old_records(10000);
+    for(size_t i = 0; i < old_records.size(); ++i) {
+        old_records[i].set<fields::ID>(i * 37);
+        old_records[i].set<fields::KIND>(i % 64);
+    }
+    status = bitpack::write_packed_file(path.c_str(), old_records);
+    assert(status == bitpack::packed_file_status::OK);
+
+    // Test that an older file upgrades lazily as its records are read
+    {
+        bitpack::versioned_packed_array<history> records;
+        status = records.open(path.c_str());
+        assert(status == bitpack::packed_file_status::OK);
+        assert(records.version() == 1 && records.upgrade_pending());
+        assert(records.size() == old_records.size());
+        assert(records.get<fields::ID>(9999) == 9999 * 37);
+        for(size_t i = 0; i < old_records.size(); ++i) {
+            assert(records.get<fields::ID>(i) == i * 37);
+            assert(records.get<fields::KIND>(i) == i % 64);
+            assert(records.get<fields::SCORE>(i) == 0);
+        }
+        records.upgrade_all();
+        assert(!records.upgrade_pending() && records.get<fields::KIND>(63) == 63);
+
+        // Test that moving an array transfers the upgraded records
+        bitpack::versioned_packed_array<history> moved = std::move(records);
+        assert(!records.is_open() && moved.is_open());
+        assert(moved.get<fields::ID>(100) == 3700);
+    }
+
+    // Test upgrading the whole file when it is opened
+    {
+        bitpack::versioned_packed_array<history> records;
+        status = records.open(path.c_str(), bitpack::upgrade_mode::ON_LOAD);
+        assert(status == bitpack::packed_file_status::OK);
+        assert(records.version() == 1 && !records.upgrade_pending());
+        assert(records[4097] == bitpack::convert<v2_layout>(old_records[4097]));
+    }
+
+    // Test that files of the current layout are read in place, and that the older layout alone can't open them
+    std::vector<v2> new_records(100);
+    for(size_t i = 0; i < new_records.size(); ++i) { new_records[i].set<fields::SCORE>(i); }
+    status = bitpack::write_packed_file(path.c_str(), new_records);
+    assert(status == bitpack::packed_file_status::OK);
+    {
+        bitpack::versioned_packed_array<history> records;
+        status = records.open(path.c_str());
+        assert(status == bitpack::packed_file_status::OK);
+        assert(records.version() == 0 && !records.upgrade_pending());
+        assert(records.get<fields::SCORE>(99) == 99);
+
+        bitpack::versioned_packed_array<bitpack::layout_history<v1_layout>> old_reader;
+        status = old_reader.open(path.c_str());
+        assert(status == bitpack::packed_file_status::SCHEMA_MISMATCH);
+        assert(!old_reader.is_open());
+    }
+
+    // Test that a file with no records opens
+    status = bitpack::write_packed_file(path.c_str(), std::vector<v1>());
+    assert(status == bitpack::packed_file_status::OK);
+    {
+        bitpack::versioned_packed_array<history> records;
+        status = records.open(path.c_str(), bitpack::upgrade_mode::ON_LOAD);
+        assert(status == bitpack::packed_file_status::OK);
+        assert(records.is_open() && records.empty() && records.version() == 1);
+    }
+    std::remove(path.c_str());
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
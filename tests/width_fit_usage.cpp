@@ -0,0 +1,75 @@
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/width_fit.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() {
+    using old_layout = bitpack::fast_layout<bitpack::bitwidth<32>, bitpack::bitwidth<16>, bitpack::bitwidth<16>>;
+    using new_layout = bitpack::small_layout<bitpack::bitwidth<10>, bitpack::bitwidth<1>, bitpack::bitwidth<13>>;
+    using old_record = bitpack::bitpack<old_layout>;
+    using new_record = bitpack::bitpack<new_layout>;
+
+    // Test fitting a plain column
+    const std::vector<std::uint32_t> column = { 3, 1000, 17, 2 };
+    assert(bitpack::fit_width(column.data(), column.size()) == 10);
+    assert(bitpack::fit_width(column.data(), column.size(), 2) == 5);
+    assert(bitpack::fit_width(column.data(), 0) == 1);
+
+    // Oversized fields holding small values
+    std::vector<old_record> records(5000);
+    for(size_t i = 0; i < records.size(); ++i) {
+        records[i].set<0>(i % 1000);
+        records[i].set<2>(i);
+    }
+
+    // Test fitting each field and spelling out the recommended layout
+    [[maybe_unused]] const auto widths = bitpack::fit_field_widths(records);
+    assert(widths[0] == 10 && widths[1] == 1 && widths[2] == 13);
+    assert(bitpack::layout_type_string(widths, bitpack::storage_preference::SMALL) ==
+           "bitpack::layout<bitpack::storage_preference::SMALL, bitpack::bitwidth<10>, bitpack::bitwidth<1>, "
+           "bitpack::bitwidth<13>>");
+
+    // Test fitting and spelling out a layout at compile time
+    static constexpr std::uint16_t sample[] = { 3, 1000, 17, 2 };
+    constexpr auto fitted = bitpack::layout_type_string(std::array<size_t, 2> { bitpack::fit_width(sample, 4), 123 });
+    static_assert(fitted == "bitpack::layout<bitpack::storage_preference::FAST, bitpack::bitwidth<10>, bitpack::bitwidth<123>>");
+    assert(fitted.str() == std::string(fitted.view()) && fitted != "bitpack::layout<>");
+
+    // Test re-packing into the recommended layout
+    std::vector<new_record> packed(records.size());
+    [[maybe_unused]] bool fits = bitpack::repack(records.data(), records.size(), packed.data());
+    assert(fits);
+    for(size_t i = 0; i < records.size(); ++i) {
+        assert(packed[i].get<0>() == records[i].get<0>());
+        assert(packed[i].get<1>() == 0);
+        assert(packed[i].get<2>() == records[i].get<2>());
+    }
+    static_assert(sizeof(new_record) == 4 && sizeof(old_record) == 8);
+
+    // Test that re-packing back is lossless, and that values too wide for the new layout are reported
+    std::vector<old_record> restored(records.size());
+    fits = bitpack::repack(packed.data(), packed.size(), restored.data());
+    assert(fits && restored == records);
+    records[4321].set<1>(2);
+    fits = bitpack::repack(records.data(), records.size(), packed.data());
+    assert(!fits);
+    assert(packed[4321].get<1>() == 0 && packed[4321].get<2>() == 4321);
+
+    // Test re-packing bitpacks with a non-default overflow policy
+    using counted_old = bitpack::bitpack<old_layout, bitpack::layout_storage_detector, bitpack::overflow_policy::COUNT>;
+    using counted_new = bitpack::bitpack<new_layout, bitpack::layout_storage_detector, bitpack::overflow_policy::COUNT>;
+    std::vector<counted_old> counted(100);
+    for(size_t i = 0; i < counted.size(); ++i) { counted[i].set<2>(i * 80); }
+    std::vector<counted_new> counted_packed(counted.size());
+    fits = bitpack::repack(counted.data(), counted.size(), counted_packed.data());
+    assert(fits && counted_packed[99].get<2>() == 99 * 80);
+
+    std::cout << "Tests passed!\n";
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <array>
+#include <bitpack/bitpack.hpp>
+#include <bitpack/layout_analysis.hpp>
+#include <bitpack/optimized_layout.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+    constexpr size_t max_fields = 64;
+    constexpr size_t max_hot    = 4;
+
+    // The offsets an optimized_layout with the first H hot fields gives the fields
+    template<size_t H>
+    std::array<size_t, max_fields> hot_offsets(const std::array<size_t, max_fields>& sizes,
+                                               const std::array<size_t, max_hot>& hot,
+                                               size_t storage_bits) {
+        std::array<size_t, H> first {};
+        for(size_t h = 0; h < H; ++h) { first[h] = hot[h]; }
+        return bitpack::detail::optimized_offsets(sizes, first, storage_bits);
+    }
+
+    int usage(const char* program) {
+        std::cerr << "usage: " << program << " [--fast | --small] [--msb-first | --hot INDEX...] WIDTH...\n";
+        return 1;
+    }
+}
+
+// Reports how a layout with the given field widths is stored, using the library's own field placement. Each --hot
+// names a hot field of an optimized_layout, up to four, hottest first.
+// Usage: bitpack_layout_analyzer [--fast | --small] [--msb-first | --hot INDEX...] WIDTH...
+int main(int argc, char** argv) {
+    std::array<size_t, max_fields> sizes {};
+    size_t count                  = 0;
+    std::array<size_t, max_hot> hot {};
+    size_t hot_count              = 0;
+    bitpack::storage_preference p = bitpack::storage_preference::FAST;
+    bitpack::field_order order    = bitpack::field_order::LSB_FIRST;
+    std::string name              = "layout<";
+
+    for(int a = 1; a < argc; ++a) {
+        if(std::strcmp(argv[a], "--fast") == 0) {
+            p = bitpack::storage_preference::FAST;
+        }
+        else if(std::strcmp(argv[a], "--small") == 0) {
+            p = bitpack::storage_preference::SMALL;
+        }
+        else if(std::strcmp(argv[a], "--msb-first") == 0) {
+            order = bitpack::field_order::MSB_FIRST;
+        }
+        else if(std::strcmp(argv[a], "--hot") == 0) {
+            char* end = nullptr;
+            if(++a == argc || hot_count == max_hot) {
+                return usage(argv[0]);
+            }
+            const auto index = std::strtoull(argv[a], &end, 10);
+            if(*end != '\0' || index >= max_fields) {
+                return usage(argv[0]);
+            }
+            hot[hot_count++] = static_cast<size_t>(index);
+        }
+        else {
+            char* end        = nullptr;
+            const auto width = std::strtoull(argv[a], &end, 10);
+            if(*end != '\0' || width == 0 || width > 64 || count == max_fields) {
+                return usage(argv[0]);
+            }
+            name += (count == 0 ? "" : ", ") + std::to_string(width);
+            sizes[count++] = static_cast<size_t>(width);
+        }
+    }
+    if(count == 0 || (hot_count > 0 && order == bitpack::field_order::MSB_FIRST)) {
+        return usage(argv[0]);
+    }
+    for(size_t h = 0; h < hot_count; ++h) {
+        for(size_t k = 0; k < h; ++k) {
+            if(hot[k] == hot[h]) {
+                return usage(argv[0]);
+            }
+        }
+        if(hot[h] >= count) {
+            return usage(argv[0]);
+        }
+    }
+
+    size_t total = 0;
+    for(size_t i = 0; i < count; ++i) { total += sizes[i]; }
+    if(total > 64) {
+        std::cerr << "layouts wider than 64 bits are not supported\n";
+        return 1;
+    }
+
+    // Unused entries of sizes are zero wide, which leaves the offsets of the given fields as the library computes them
+    std::array<size_t, max_fields> offsets {};
+    const size_t storage_bits = bitpack::detail::detected_storage_bits(p, total);
+    switch(hot_count) {
+    case 0: offsets = bitpack::detail::field_offsets(sizes, order); break;
+    case 1: offsets = hot_offsets<1>(sizes, hot, storage_bits); break;
+    case 2: offsets = hot_offsets<2>(sizes, hot, storage_bits); break;
+    case 3: offsets = hot_offsets<3>(sizes, hot, storage_bits); break;
+    default: offsets = hot_offsets<4>(sizes, hot, storage_bits); break;
+    }
+
+    const auto analysis = bitpack::analyze_fields(sizes, offsets, count, 0, p);
+    bitpack::write_layout_analysis(std::cout, name + ">", analysis);
+    return 0;
+}